@@ -5,6 +5,7 @@
 #ifndef ZGRAPH_GRAPH_H_
 #define ZGRAPH_GRAPH_H_
 
+#include <stdint.h>
 #include "hashtable/hash_table.h"
 #include "hashtable/hash_set.h"
 #include "list/array_list.h"
@@ -25,6 +26,14 @@ typedef void *GraphData;
 typedef struct Vertex Vertex;
 typedef struct Edge Edge;
 typedef struct Graph Graph;
+typedef struct SearchWorkspace SearchWorkspace;
+typedef struct IdUnionFind IdUnionFind;
+typedef struct CutIndex CutIndex;
+
+/**
+ * receives the edges of a spanning forest one at a time, the edge is not kept after the call.
+ */
+typedef void (*SpanningEdgeHandler)(void *ctx, int from, int to, int weight);
 
 /**
  * for iteration graph
@@ -34,6 +43,77 @@ typedef struct VertexEntry {
   int size;
 } VertexEntry;
 
+/**
+ * hop distances from a list of sources. hops[row * size + column] is the distance from
+ * source_list[row] to id_list[column], -1 if unreachable.
+ */
+typedef struct HopMatrix {
+  int *source_list;
+  int source_size;
+  int *id_list;
+  int size;
+  int *hops;
+} HopMatrix;
+
+/**
+ * a value for each vertex, label[i] belongs to id_list[i].
+ */
+typedef struct VertexLabel {
+  int *id_list;
+  int *label;
+  int size;
+} VertexLabel;
+
+/**
+ * bridges, cut points and blocks of undirected graph.
+ * bridge i is the edge <bridges[2 * i], bridges[2 * i + 1]>.
+ * vertexes of block i are block_vertex[block_offset[i]] ... block_vertex[block_offset[i + 1] - 1], a cut point
+ * belongs to every block it separates, an isolated vertex is a block by itself.
+ */
+typedef struct Biconnectivity {
+  int *bridges;
+  int bridge_size;
+  int *cut_points;
+  int cut_point_size;
+  int *block_offset;
+  int *block_vertex;
+  int block_size;
+} Biconnectivity;
+
+/**
+ * minimum s-t cut of a flow network, or global minimum cut of undirected graph.
+ * vertex id_list[i] is on the source side if bit i of side is set, that is side[i / 64] >> (i % 64) & 1.
+ * cut edge i is the edge <cut_edges[2 * i], cut_edges[2 * i + 1]> from the source side to the other side,
+ * value is the sum of their weights, equal to the max flow for s-t cut.
+ */
+typedef struct StCut {
+  int *id_list;
+  uint64_t *side;
+  int size;
+  int *cut_edges;
+  int cut_edge_size;
+  int value;
+} StCut;
+
+/**
+ * return value of the callbacks of GraphVisitor.
+ * VISIT_SKIP on discover does not expand the vertex, on examine_edge does not follow the edge.
+ */
+typedef enum {
+  VISIT_STOP, VISIT_CONTINUE, VISIT_SKIP
+} VisitResult;
+
+/**
+ * callbacks for graph_dfs_visit and graph_bfs_visit, any of them can be NULL.
+ * pid is the vertex that id is discovered from, the parent of the start vertex is itself.
+ */
+typedef struct GraphVisitor {
+  VisitResult (*discover)(void *ctx, int id, int pid);
+  VisitResult (*finish)(void *ctx, int id, int pid);
+  VisitResult (*examine_edge)(void *ctx, Edge *edge);
+  void *ctx;
+} GraphVisitor;
+
 Graph *create_graph(int directed, int weighted);
 /**
  * add a data in graph.
@@ -200,7 +280,8 @@ VertexEntry *bfs_graph(Graph *graph);
  * for undirected graph:
  *  - a bridge is an edge whose removal increases the number of connected components
  * for directed graph:
- *  - a bridge is an edge whose removal increases the number of strongly connected components
+ *  - a bridge is an edge whose removal increases the number of strongly connected components (strong bridge),
+ *    found in linear time from dominator trees of every strongly connected component and its reverse.
  *
  * @return a list of edges
  */
@@ -210,6 +291,9 @@ LinkedList *find_bridge(Graph *graph);
  * find cut points of the graph.
  * for undirected graph:
  * - a cut points is a vertex whose removal changes the number of connected components.
+ * for directed graph:
+ * - a cut point is a vertex whose removal increases the number of strongly connected components (strong
+ *   articulation point), found from dominator trees as for bridges.
  *
  * @param graph
  * @return
@@ -250,21 +334,65 @@ int has_euler_loop(Graph *graph);
 LinkedList *hierholzer_euler_loop(Graph *graph);
 
 /**
- * kruskal minimum spanning tree algorithm
+ * kruskal minimum spanning tree algorithm, the same function as filter_kruskal_mst.
  *
  * @param graph
- * @return
+ * @return  list of edges of the tree, NULL if the graph is not connected
  */
 LinkedList *kruskal_mst(Graph *graph);
 
 /**
- * Prim minimum spanning tree algorithm
+ * Filter-Kruskal minimum spanning tree, the algorithm of kruskal_msf. Edges are kept as contiguous
+ * (weight, from, to) triples, split around a random pivot weight, and heavy edges whose ends are already
+ * connected are filtered out before they are sorted. Small ranges are radix sorted by weight.
  *
  * @param graph
- * @return
+ * @return  list of edges of the tree, NULL if the graph is not connected
+ */
+LinkedList *filter_kruskal_mst(Graph *graph);
+
+/**
+ * Multi-threaded minimum spanning forest (Boruvka). In every round each component picks its lightest leaving
+ * edge with an atomic min over the edges left, then components are hooked along them and contracted. Edges that
+ * end up inside one component are dropped after each round.
+ *
+ * @param graph
+ * @param threads   amount of threads, <= 0 to use one per online core
+ * @return  list of edges of the forest, one tree for every connected component
+ */
+LinkedList *boruvka_msf(Graph *graph, int threads);
+
+/**
+ * Prim minimum spanning tree algorithm, run as prim_msf.
+ *
+ * @param graph
+ * @return  list of edges of the tree, NULL if the graph is not connected
  */
 LinkedList *prim_mst(Graph *graph);
 
+/**
+ * kruskal minimum spanning forest, a tree for every connected component with no connectivity check up front.
+ * edges are passed to handler as they are accepted, in ascending order of weight.
+ *
+ * @param graph
+ * @param handler
+ * @param ctx       passed to handler
+ * @return  amount of trees
+ */
+int kruskal_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx);
+
+/**
+ * Prim minimum spanning forest, grows a tree from every vertex not reached yet. edges are passed to handler
+ * as they are accepted, from the vertex in the tree to the new one. Eager variant over dense slots: the heap
+ * is indexed by vertex and holds at most V entries whose key is decreased, O(ElogV).
+ *
+ * @param graph
+ * @param handler
+ * @param ctx       passed to handler
+ * @return  amount of trees
+ */
+int prim_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx);
+
 /**
  * Dijkstra algorithm for shortest path of weighted graph with no negative edges.
  * return a map of <id,dis>
@@ -375,6 +503,71 @@ Hashtable *scc_kosaraju(Graph *graph);
  */
 Hashtable *max_flow(Graph *graph, int source, int to, int *max_flow);
 
+/**
+ * Max flow of the graph with given source and to, by Dinic algorithm over a flat residual arc array.
+ * Each phase builds the level graph by bfs and saturates it by a blocking flow, where current arc pointers
+ * make every arc to be passed at most once per phase. return a map of the flow of each edge, same as max_flow.
+ * O(V^2*E)
+ *
+ * @param graph
+ * @param source
+ * @param to
+ * @param max_flow
+ * @return
+ */
+Hashtable *dinic_max_flow(Graph *graph, int source, int to, int *max_flow);
+
+/**
+ * Max flow of the graph with given source and to, by fifo push-relabel with global relabel and gap heuristic.
+ * Usually the fastest on dense networks. return a map of the flow of each edge, same as max_flow.
+ * O(V^3)
+ *
+ * @param graph
+ * @param source
+ * @param to
+ * @param max_flow
+ * @return
+ */
+Hashtable *push_relabel_max_flow(Graph *graph, int source, int to, int *max_flow);
+
+/**
+ * minimum cut between source and to, read off the residual network of dinic_max_flow: the source side is
+ * every vertex still reachable from source, the smallest one among minimum cuts.
+ *
+ * @param graph
+ * @param source
+ * @param to
+ * @return
+ */
+StCut *min_st_cut(Graph *graph, int source, int to);
+
+void free_st_cut(StCut *cut);
+
+/**
+ * global minimum cut of undirected graph with non-negative weights, by Stoer-Wagner. Each phase orders the
+ * vertexes by maximum adjacency with an indexed heap, and merges the last two after recording the cut around
+ * the last one.
+ * O(V*E*logV)
+ *
+ * @param graph
+ * @return  NULL if the graph is directed, not weighted or has less than 2 vertexes
+ */
+StCut *stoer_wagner_min_cut(Graph *graph);
+
+/**
+ * global minimum cut of undirected graph with non-negative weights, by Karger-Stein recursive contraction.
+ * Independent trials run on threads, each finds the minimum cut with probability about 1/logV.
+ * The result only depends on seed and trials, not on threads.
+ * O(V^2*logV) for each trial on dense graph
+ *
+ * @param graph
+ * @param trials    amount of trials, <= 0 for logV^2 trials which miss the minimum cut with probability 1/V
+ * @param threads   amount of threads, <= 0 to use one per online core
+ * @param seed
+ * @return  NULL if the graph is directed, not weighted or has less than 2 vertexes
+ */
+StCut *karger_stein_min_cut(Graph *graph, int trials, int threads, unsigned int seed);
+
 /**
  * bipartite matching using max flow algorithm.
  *
@@ -390,6 +583,328 @@ int bipartite_matching(Graph* graph);
  * @return
  */
 int hungarian_matching(Graph* graph);
+
+/**
+ * Direction-optimizing BFS from s. Expands the frontier top-down while it is small, and switches to
+ * bottom-up (every unvisited vertex scans its in edges for a parent in the frontier) when the frontier
+ * covers a large part of the remaining edges. Works on a dense snapshot of the adjacency.
+ *
+ * return a map of <id,pid> like single_source_path(graph, s, BFS): every reachable vertex gets a parent
+ * on the previous BFS level, so the map gives shortest paths for unweighted graph.
+ *
+ * @param graph
+ * @param s
+ * @return
+ */
+Hashtable *direction_optimizing_bfs(Graph *graph, int s);
+
+/**
+ * Multi-threaded level-synchronous BFS of the whole graph, like bfs_graph. Each level of the frontier is
+ * split among threads that collect their own next frontier, vertexes are claimed with an atomic
+ * compare-and-swap on a parent array, and the local frontiers are merged at the end of each level.
+ * Vertexes of every component are returned in level order.
+ *
+ * @param graph
+ * @param threads   amount of threads, <= 0 to use one per online core
+ * @return
+ */
+VertexEntry *bfs_graph_par(Graph *graph, int threads);
+
+/**
+ * Multi-source bit-parallel BFS (MS-BFS). Sources are processed in batches of up to 256: every vertex keeps
+ * bitsets of the sources that have reached it and of the sources whose frontier it belongs to, so each
+ * adjacency scan is shared by the whole batch.
+ *
+ * return NULL if any source is not in the graph.
+ *
+ * @param graph
+ * @param sources
+ * @param source_size
+ * @return
+ */
+HopMatrix *multi_source_bfs(Graph *graph, int *sources, int source_size);
+
+void free_hop_matrix(HopMatrix *matrix);
+
+/**
+ * dfs from s calling the visitor: discover when a vertex is reached, examine_edge for every out edge of it,
+ * finish when all its edges are done. Nothing of size O(V) is allocated upfront, so a search can stop
+ * after touching a few vertexes.
+ *
+ * @param graph
+ * @param s
+ * @param visitor
+ * @return  VISIT_CONTINUE if the traversal completed, VISIT_STOP if a callback stopped it,
+ *          GRAPH_ERROR if s is not in the graph
+ */
+int graph_dfs_visit(Graph *graph, int s, GraphVisitor *visitor);
+
+/**
+ * bfs from s calling the visitor: discover when a vertex is put into the queue, examine_edge for every
+ * out edge when it is taken out, finish after its edges. VISIT_STOP from discover ends the search before any
+ * vertex of the next level is taken out, VISIT_SKIP from discover still queues the vertex but none of its edges
+ * are examined.
+ *
+ * @param graph
+ * @param s
+ * @param visitor
+ * @return  same as graph_dfs_visit
+ */
+int graph_bfs_visit(Graph *graph, int s, GraphVisitor *visitor);
+
+void free_vertex_label(VertexLabel *vertex_label);
+
+/**
+ * scratch space for local searches. A search only touches the vertexes it reaches, and the next search
+ * clears just those, so a workspace can be reused for many small queries on a big graph.
+ *
+ * @return
+ */
+SearchWorkspace *create_search_workspace(void);
+
+void free_search_workspace(SearchWorkspace *workspace);
+
+/**
+ * vertexes within k hops from s, in bfs order. label is the amount of hops.
+ *
+ * return NULL if s is not in the graph or k < 0.
+ *
+ * @param graph
+ * @param s
+ * @param k
+ * @param workspace   can be NULL
+ * @return
+ */
+VertexLabel *k_hop_neighborhood(Graph *graph, int s, int k, SearchWorkspace *workspace);
+
+/**
+ * dijkstra from s that does not go beyond radius. return the vertexes whose distance is not larger than
+ * radius, in the order they are settled. label is the distance. Weights must be non-negative, only the edges
+ * the search reaches are checked.
+ *
+ * return NULL if s is not in the graph, radius < 0 or the search meets a negative weight edge.
+ *
+ * @param graph
+ * @param s
+ * @param radius
+ * @param workspace   can be NULL
+ * @return
+ */
+VertexLabel *dijkstra_within(Graph *graph, int s, int radius, SearchWorkspace *workspace);
+
+/**
+ * strongly connected components in one iterative dfs (Pearce's variant of Tarjan). No reversed graph is
+ * built, besides the result only O(V) words are used.
+ *
+ * return label of component id for every vertex. ids are in [0, amount of components) and in reverse
+ * topological order: an edge between two components goes from a larger id to a smaller one.
+ *
+ * @param graph
+ * @return
+ */
+VertexLabel *scc_pearce(Graph *graph);
+
+/**
+ * Multi-threaded strongly connected components. Vertexes without in or out edges are trimmed as single
+ * components first, then the component of a pivot of large degree is found as the intersection of its
+ * forward and backward reachable sets, and the rest is split by propagating max colors forward and
+ * collecting every color root's component backward.
+ *
+ * return label of component id for every vertex, ids are in [0, amount of components) in no special order.
+ *
+ * @param graph
+ * @param threads   amount of threads, <= 0 to use one per online core
+ * @return
+ */
+VertexLabel *scc_par(Graph *graph, int threads);
+
+/**
+ * union find over arbitrary int ids. ids are renumbered to dense slots as they come, the forest uses union by
+ * rank and path halving, so edges can be streamed in without knowing the ids upfront.
+ *
+ * @return
+ */
+IdUnionFind *create_id_uf(void);
+
+/**
+ * add id as a set of its own.
+ *
+ * @param uf
+ * @param id
+ * @return  1 if added, 0 if id is already in uf
+ */
+int id_uf_add(IdUnionFind *uf, int id);
+
+/**
+ * merge the sets of id1 and id2, ids not in uf are added first.
+ *
+ * @param uf
+ * @param id1
+ * @param id2
+ * @return  1 if two sets are merged, 0 if they are already the same set
+ */
+int id_uf_union(IdUnionFind *uf, int id1, int id2);
+
+/**
+ * representative id of the set of id. an id not in uf is a set of its own, so id is returned.
+ *
+ * @param uf
+ * @param id
+ * @return
+ */
+int id_uf_find(IdUnionFind *uf, int id);
+
+int id_uf_same_set(IdUnionFind *uf, int id1, int id2);
+
+/**
+ * amount of sets
+ *
+ * @param uf
+ * @return
+ */
+int id_uf_count(IdUnionFind *uf);
+
+void free_id_uf(IdUnionFind *uf);
+
+/**
+ * connected components by one pass of union find over the edges, no dfs. For directed graph the
+ * components are weakly connected.
+ *
+ * return label of component id for every vertex, ids are in [0, amount of components).
+ *
+ * @param graph
+ * @return
+ */
+VertexLabel *graph_components_uf(Graph *graph);
+
+/**
+ * Multi-threaded connected components (Afforest). Vertexes are hooked lock-free on an atomic parent array,
+ * first along a couple of edges of every vertex, then the largest component is guessed from a sample and
+ * only vertexes outside of it hook along their remaining edges. For directed graph the components are
+ * weakly connected.
+ *
+ * return label of component id for every vertex, ids are in [0, amount of components).
+ *
+ * @param graph
+ * @param threads   amount of threads, <= 0 to use one per online core
+ * @return
+ */
+VertexLabel *graph_components_par(Graph *graph, int threads);
+
+/**
+ * keep an index of the connected components of undirected graph, updated by add_edge. has_path and
+ * component_count are answered from the index in near constant time. Removing edges or vertexes marks the
+ * index stale, and the next query rebuilds it.
+ *
+ * @param graph
+ * @return  GRAPH_SUCCESS, GRAPH_ERROR if the graph is directed
+ */
+int enable_connectivity_index(Graph *graph);
+
+void disable_connectivity_index(Graph *graph);
+
+/**
+ * keep a spanning forest of undirected graph in euler tour trees, updated by add_edge, remove_edge and
+ * remove_vertex. When a tree edge is removed a replacement is searched among the non-tree edges of the
+ * smaller side. has_path is answered in O(log V) and component_count is read from counters. Takes
+ * precedence over enable_connectivity_index.
+ *
+ * @param graph
+ * @return  GRAPH_SUCCESS, GRAPH_ERROR if the graph is directed
+ */
+int enable_dynamic_connectivity(Graph *graph);
+
+void disable_dynamic_connectivity(Graph *graph);
+
+/**
+ * bridges, cut points and biconnected components (blocks) of undirected graph in one iterative
+ * Hopcroft-Tarjan pass over flat arrays, the edges of a block are popped from an edge stack.
+ *
+ * @param graph
+ * @return  NULL if the graph is directed
+ */
+Biconnectivity *biconnectivity(Graph *graph);
+
+void free_biconnectivity(Biconnectivity *biconnectivity);
+
+/**
+ * index of undirected graph for what-if queries on single vertex or edge failures. Built from the
+ * biconnectivity pass as the block-cut tree and the bridge tree (2-edge-connected components joined by
+ * bridges), both with binary lifting for LCA. The index is a snapshot, rebuild it after changing the graph.
+ *
+ * @param graph
+ * @return  NULL if the graph is directed
+ */
+CutIndex *create_cut_index(Graph *graph);
+
+/**
+ * test if removing vertex x disconnects a from b, in O(log V).
+ *
+ * @param index
+ * @param x
+ * @param a
+ * @param b
+ * @return  1 if a and b are connected and every path between them passes x, 0 otherwise or if any of the
+ *          vertexes is missing, a == b, or x is a or b
+ */
+int cut_vertex_separates(CutIndex *index, int x, int a, int b);
+
+/**
+ * test if removing edge <u, v> disconnects a from b, in O(1).
+ *
+ * @param index
+ * @param u
+ * @param v
+ * @param a
+ * @param b
+ * @return  1 if <u, v> is a bridge on the path between a and b, 0 otherwise
+ */
+int cut_edge_separates(CutIndex *index, int u, int v, int a, int b);
+
+void free_cut_index(CutIndex *index);
+
+/**
+ * immediate dominators of the vertexes reachable from root, by Lengauer-Tarjan over dense dfs numbering.
+ * d dominates v if every path from root to v passes d.
+ *
+ * return label of immediate dominator for every reachable vertex, the label of root is root.
+ *
+ * @param graph
+ * @param root
+ * @return  NULL if root is not in the graph
+ */
+VertexLabel *dominator_tree(Graph *graph, int root);
+
+/**
+ * keep a minimum spanning forest of undirected weighted graph in a link-cut tree, updated by add_edge in
+ * O(logV): an edge joining two trees is linked, otherwise it replaces the heaviest edge on the cycle it closes
+ * if it is lighter. Removing edges or vertexes or changing weights marks the forest stale, and the next
+ * query rebuilds it.
+ *
+ * @param graph
+ * @return  GRAPH_SUCCESS, GRAPH_ERROR if the graph is directed or not weighted
+ */
+int enable_incremental_msf(Graph *graph);
+
+void disable_incremental_msf(Graph *graph);
+
+/**
+ * total weight of the minimum spanning forest kept by enable_incremental_msf.
+ *
+ * @param graph
+ * @return
+ */
+long incremental_msf_weight(Graph *graph);
+
+/**
+ * pass the edges of the minimum spanning forest kept by enable_incremental_msf to handler.
+ *
+ * @param graph
+ * @param handler
+ * @param ctx       passed to handler
+ * @return  amount of trees
+ */
+int incremental_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx);
 #ifdef __cplusplus
 }
 #endif
@@ -5,11 +5,31 @@
 #include "hashtable/hash-int.h"
 #include "hashtable/compare-int.h"
 #include "queue/dqueue_ll.h"
-#include "unionfind/union_find.h"
 #include "queue/priority_queue.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// direction-optimizing bfs switches to bottom-up when arcs of frontier > arcs of unexplored / ALPHA,
+// and back to top-down when the frontier shrinks below vertex count / BETA
+#define DO_BFS_ALPHA 14
+#define DO_BFS_BETA 24
+// parallel algorithms hand out work in chunks of this many items, and run inline below it
+#define PAR_GRAIN 256
+// multi-source bfs runs up to 64 * MS_BFS_WORDS sources in one batch
+#define MS_BFS_WORDS 4
+// afforest hooks along this many edges of every vertex before sampling the largest component
+#define AFFOREST_ROUNDS 2
+#define AFFOREST_SAMPLES 1024
+// filter-kruskal sorts ranges of at most this many edges instead of partitioning them further
+#define FILTER_KRUSKAL_BASE 1024
+// karger-stein stops contracting at this many vertexes and finishes by dense stoer-wagner, at most 32
+#define KARGER_STEIN_BASE 16
 
 struct Vertex {
   int id;
@@ -22,6 +42,9 @@ struct Edge {
   int to;
 };
 
+typedef struct DynamicConnectivity DynamicConnectivity;
+typedef struct IncrementalMsf IncrementalMsf;
+
 struct Graph {
   int last_continuous_id;
   int vertex_size; // amount of vertex
@@ -32,8 +55,287 @@ struct Graph {
   Hashtable *edges; // <id:int*, hashset<Edge*>> map
   Hashtable *in_degree; // in degree map
   Hashtable *out_degree; // out degree map
+  IdUnionFind *connectivity; // components kept by add_edge if enabled, NULL otherwise
+  int connectivity_stale; // 1 if edges or vertexes are removed since connectivity was built
+  DynamicConnectivity *dynamic; // spanning forest kept by add_edge and remove_edge if enabled, NULL otherwise
+  IncrementalMsf *msf; // minimum spanning forest kept by add_edge if enabled, NULL otherwise
+};
+
+/**
+ * compact snapshot of the adjacency. vertexes are renumbered to dense slots [0, n) so that
+ * algorithms can keep their state in flat arrays instead of hashtables of boxed ints.
+ */
+typedef struct CSR {
+  int n; // amount of vertex
+  int m; // amount of arcs. an undirected edge is stored once in each direction
+  int *ids; // <slot, id>
+  Hashtable *slots; // <id, &ids[slot]>
+  int *offset; // out arcs of slot v are adj[offset[v]] ... adj[offset[v+1]-1]
+  int *adj; // target slot of arcs
+  int *weight; // weight of arcs
+  int *in_offset; // in arcs, built on demand by csr_build_in. same as out arcs for undirected graph
+  int *in_adj;
+  int *in_weight;
+  int directed;
+} CSR;
+
+// an undirected edge between slots, stored contiguously for sorting
+typedef struct WeightedArc {
+  int weight;
+  int from;
+  int to;
+} WeightedArc;
+
+// binary min heap of slots with a key each, pos[v] is the index of v in heap, -1 if v is not in it
+typedef struct IndexedHeap {
+  int *heap;
+  int *pos;
+  int *key;
+  int size;
+} IndexedHeap;
+
+// residual network over csr slots. arc 2k is the k-th csr arc with its capacity and arc 2k+1 is its reverse
+// with capacity 0, so the reverse of arc e is e^1 and the flow on the k-th csr arc is cap[2k+1].
+// arcs leaving slot v are arc[offset[v]] ... arc[offset[v+1]-1]
+typedef struct FlowNetwork {
+  CSR *csr;
+  int n;
+  int *offset;
+  int *arc;
+  int *head; // head slot of arc
+  int *cap; // residual capacity of arc
+} FlowNetwork;
+
+// state of fifo push-relabel over a flow network. height of s and t is fixed, count[h] is the amount of
+// vertexes on height h < n for gap heuristic, and queue is a ring of the active vertexes.
+typedef struct PushRelabel {
+  FlowNetwork *network;
+  int s;
+  int t;
+  int *height;
+  long *excess;
+  int *current;
+  int *count;
+  int *queue;
+  int head;
+  int size;
+  char *active;
+  int relabels; // since the last global relabel
+} PushRelabel;
+
+// independent karger-stein trials shared by threads. trial i draws from its own seed, and every thread keeps
+// the best cut of its trials, so the result only depends on seed and trials.
+typedef struct KargerStein {
+  WeightedArc *arcs; // edges of positive weight
+  int arc_size;
+  int n;
+  int trials;
+  unsigned int seed;
+  atomic_int cursor;
+  int *best; // <thread, value of its best cut>
+  int *best_trial;
+  char **side; // <thread, side of its best cut over slots>
+} KargerStein;
+
+// state of one trial, the best cut of the trials run so far by its thread
+typedef struct KsTrial {
+  int n;
+  unsigned int rng;
+  int best;
+  char *side;
+  char *buffer;
+} KsTrial;
+
+// contracted graph of k vertexes on a level of the recursion. relabel maps the vertexes of the level above to
+// the vertexes of this one, the top level has no relabel
+typedef struct KsLevel {
+  WeightedArc *arcs;
+  int size;
+  int k;
+  int *relabel;
+  struct KsLevel *up;
+} KsLevel;
+
+// growable int array for per-thread output buffers
+typedef struct IntArray {
+  int *data;
+  int size;
+  int capacity;
+} IntArray;
+
+// dense index of a vertex id. id is the first field so that it can be used as key
+typedef struct IdSlot {
+  int id;
+  int idx;
+} IdSlot;
+
+typedef struct SearchHeapNode {
+  int dis;
+  int idx;
+} SearchHeapNode;
+
+struct SearchWorkspace {
+  Hashtable *index; // <id, IdSlot*>
+  int *ids;         // touched vertexes
+  int *label;
+  char *settled;
+  int size;
+  int capacity;
+  IntArray queue;
+  SearchHeapNode *heap;
+  int heap_size;
+  int heap_capacity;
+};
+
+// union find over dense slots, union by rank and path halving
+typedef struct DenseUF {
+  int *parent;
+  unsigned char *rank;
+  int size;
+  int capacity;
+  int count;
+} DenseUF;
+
+struct IdUnionFind {
+  Hashtable *index; // <id, IdSlot*>
+  int *ids;
+  DenseUF uf;
+};
+
+/**
+ * node of an euler tour, kept in a treap by position. a tree of n vertexes is a tour of n vertex nodes and
+ * two arc nodes for every tree edge.
+ */
+typedef struct EttNode {
+  struct EttNode *left;
+  struct EttNode *right;
+  struct EttNode *parent;
+  unsigned int priority;
+  int size;        // nodes in subtree
+  int vertices;    // vertex nodes in subtree
+  int nontree;     // non-tree edges of vertex nodes in subtree
+  int slot;        // slot of vertex, -1 for an arc
+  int own_nontree; // non-tree edges of this vertex
+} EttNode;
+
+// a tree edge, edge.from < edge.to. edge is the first field so that it can be used as key
+typedef struct TreeArc {
+  Edge edge;
+  EttNode *uv;
+  EttNode *vu;
+} TreeArc;
+
+struct DynamicConnectivity {
+  Hashtable *index; // <id, IdSlot*>
+  int *ids;
+  EttNode **nodes;  // vertex node of every slot, NULL if the vertex is removed
+  int size;
+  int capacity;
+  Hashtable *tree;  // <Edge*, TreeArc*>
+  int vertex_count;
+  int tree_edges;
+  unsigned int seed;
+};
+
+/**
+ * node of a link-cut tree. a tree edge of the forest is a node between the nodes of its two vertexes, so that
+ * the heaviest edge on a path is the max of a splay tree.
+ */
+typedef struct LctNode {
+  int child[2];
+  int parent; // parent in the splay tree, or path parent for the root of a splay tree
+  int flip;   // children of the subtree are to be swapped
+  int weight; // weight of an edge node, INT_MIN for a vertex node
+  int max;    // node of the max weight in the splay subtree
+  int from;   // nodes of the ends of an edge node, -1 for a vertex node or a free edge node
+  int to;
+} LctNode;
+
+struct IncrementalMsf {
+  Hashtable *index;    // <id, IdSlot*>, idx is the node of the vertex
+  LctNode *nodes;
+  int *ids;            // id of every vertex node
+  int size;
+  int capacity;
+  IntArray free_nodes; // edge nodes cut from the forest
+  IntArray path;       // scratch of splay
+  long weight;
+  int tree_edges;
+  int vertex_count;
+  int stale;           // 1 if edges or vertexes are removed or weights changed since the forest was built
+};
+
+// rooted spanning forest with binary lifting, up[k * n + v] is the 2^k-th ancestor of v, roots are their own
+typedef struct LcaForest {
+  int n;
+  int levels;
+  int *up;
+  int *depth;
+  int *tin;  // dfs enter and exit times, u is an ancestor of v iff [tin, tout] of u covers the one of v
+  int *tout;
+  int *root;
+} LcaForest;
+
+struct CutIndex {
+  CSR *index;         // ids and slots of the vertexes
+  char *is_cut;
+  int *block_node;    // node of every slot in block_cut: the cut node of a cut point, otherwise its block
+  LcaForest *block_cut;
+  int *two_edge;      // 2-edge-connected component of every slot, the node in bridge_tree
+  int *bridge_end;    // slots of the bridge from node i of bridge_tree to its parent at 2 * i, 2 * i + 1
+  LcaForest *bridge_tree;
 };
 
+// task run by every thread of parallel_run. tid is in [0, threads)
+typedef void (*ParallelTask)(void *ctx, int tid, int threads);
+
+/**
+ * type of an edge met by dfs, as in the classic edge classification of directed graph.
+ * for undirected graph every edge is met from both ends, the edge back to the parent is a back edge.
+ */
+typedef enum {
+  DFS_TREE_EDGE, DFS_BACK_EDGE, DFS_FORWARD_EDGE, DFS_CROSS_EDGE
+} DfsEdgeType;
+
+/**
+ * callbacks of dfs engine, any of them can be NULL. a callback returns a VisitResult: VISIT_STOP (0) to stop
+ * the traversal, VISIT_SKIP from pre_visit to not expand the vertex and from edge to not follow a tree edge.
+ * pid is the parent of the vertex (pid == id for the root), for edge callback the parent of edge->from.
+ */
+typedef struct DfsHandler {
+  int (*pre_visit)(void *ctx, int id, int pid);
+  int (*post_visit)(void *ctx, int id, int pid);
+  int (*edge)(void *ctx, Edge *edge, DfsEdgeType type, int pid);
+  void *ctx;
+} DfsHandler;
+
+// discovery order of a visited vertex. id is the first field so that the mark is its own hashtable key
+typedef struct DfsMark {
+  int id;
+  int ord;
+  int finished;
+} DfsMark;
+
+typedef struct DfsFrame {
+  int id;
+  int pid;
+  int ord;
+  HashsetIterator *iter;
+} DfsFrame;
+
+/**
+ * explicit stack dfs. marks are kept across runs, so that a graph can be covered by running from
+ * every vertex not visited yet.
+ */
+typedef struct DfsEngine {
+  Graph *graph;
+  Hashtable *marks; // <id, DfsMark*>
+  int order;
+  DfsFrame *stack;
+  int stack_size;
+  int stack_capacity;
+} DfsEngine;
+
 static unsigned int default_vertex_hash_func(void *v);
 static int default_vertex_equal_func(void *v1, void *v2);
 static unsigned int default_edge_hash_func(void *);
@@ -53,19 +355,23 @@ static int remove_edges_from(Hashset *hashset, int from_id);
 static int remove_edges_to(Hashset *hashset, int to_id);
 static int remove_edge_from_to(Hashset *hashset, int from_id, int to_id);
 
-static void dfs(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry);
+static DfsEngine *create_dfs_engine(Graph *graph);
+static int dfs_engine_visited(DfsEngine *engine, int id);
+static int dfs_engine_run(DfsEngine *engine, int root, DfsHandler *handler);
+static void free_dfs_engine(DfsEngine *engine);
+static void dfs(DfsEngine *engine, int id, VertexEntry *vertex_entry);
 static int *new_id(int value);
 static VertexEntry *new_vertex_entry(int v_size);
 static void dfs_nr(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry);
-static void dfs_visit(Graph *graph, Hashset *visited, int id);
-static void dfs_cid(Graph *graph, Hashtable *visited, int id, int cid);
-static void dfs_par(Graph *graph, Hashtable *par, int id, int pid);
-static int dfs_cmp(Graph *graph, Hashtable *par, int id, int pid, int target);
+static void dfs_visit(DfsEngine *engine, int id);
+static void dfs_cid(DfsEngine *engine, Hashtable *visited, int id, int cid);
+static void dfs_par(DfsEngine *engine, Hashtable *par, int id);
+static int dfs_cmp(DfsEngine *engine, Hashtable *par, int id, int target);
 
 static int has_circle_undirected_graph(Graph *graph);
 static int has_circle_directed_graph(Graph *graph);
-static int dfs_circle_test_undirected(Graph *graph, Hashtable *visited, int id, int pid);
-static int dfs_circle_test_directed(Graph *graph, Hashtable *visited, Hashset *on_path, int id, int pid);
+static int dfs_circle_test_undirected(DfsEngine *engine, int id);
+static int dfs_circle_test_directed(DfsEngine *engine, int id);
 static void ud_circle_path(Graph *graph,
                            Hashset *visited,
                            Hashtable *path_visited,
@@ -76,33 +382,15 @@ static void d_circle_path(Graph *graph, Hashset *visited, Hashtable *on_path, in
 static ArrayList *truncate_list(ArrayList *list, int start_element);
 static LinkedList *track_path(Hashtable *path, int last_element, int start_element);
 
-static int dfs_bipartite_test(Graph *graph, Hashtable *visited, int id, int color);
+static int dfs_bipartite_test(DfsEngine *engine, Hashtable *visited, int id, int color);
 static void bfs(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry);
 static void bfs_par(Graph *graph, Hashtable *par, int id, int pid);
 static int bfs_cmp(Graph *graph, Hashtable *visited, int id, int pid, int target);
-static void find_bridge_ud(Graph *graph,
-                           Hashset *visited,
-                           Hashtable *ord,
-                           Hashtable *low,
-                           int visited_count,
-                           int id,
-                           int pid,
-                           LinkedList *result);
-static void find_cut_point_ud(Graph *graph,
-                              Hashset *visited,
-                              Hashtable *ord,
-                              Hashtable *low,
-                              int visited_count,
-                              int id,
-                              int pid,
-                              LinkedList *result);
 static int dfs_hamilton_loop_path(Graph *graph, Hashtable *visited, int start, int *end, int id, int pid);
 static int dfs_hamilton_path(Graph *graph, Hashtable *visited, int *end, int id, int pid);
 static int pick_one_id(Graph *graph);
 static Edge *pick_one_edge(Hashset *edge);
 static Hashtable *copy_edges(Graph *graph);
-static int edge_weight_compare(void *e1, void *e2);
-static int edge_weight_compare_pq(void *e1, void *e2);
 // for dijkstra algorithm in priority queue
 typedef struct DIS DIS;
 static DIS *create_dis(int id, int dis);
@@ -110,6 +398,116 @@ static int dis_compare_pq(DIS *d1, DIS *d2);
 static Graph *create_residual_graph(Graph *graph);
 static LinkedList *get_augmenting_path(Graph *rg, int s, int t);
 static int bfs_hungarian(Graph *graph, Hashtable *matching, int id);
+
+static CSR *create_csr(Graph *graph);
+static CSR *create_csr_index(Graph *graph);
+static void csr_build_in(CSR *csr);
+static int csr_slot(CSR *csr, int id);
+static void free_csr(CSR *csr);
+static Hashtable *slot_parent_to_map(CSR *csr, int *parent);
+static int bfs_top_down_step(CSR *csr, int *parent, int *frontier, int frontier_size, int *next);
+static int bfs_bottom_up_step(CSR *csr, int *parent, uint64_t *frontier, uint64_t *next);
+static int resolve_threads(int threads);
+static void parallel_run(int threads, ParallelTask task, void *ctx);
+static void int_array_push(IntArray *array, int value);
+static void par_bfs_level(void *ctx, int tid, int threads);
+static void ms_bfs_batch(CSR *csr, int *sources, int source_size, int *hops);
+static int visitor_discover(void *ctx, int id, int pid);
+static VertexLabel *new_vertex_label(int size);
+static void reset_search_workspace(SearchWorkspace *workspace);
+static int search_slot(SearchWorkspace *workspace, int id, int *fresh);
+static VertexLabel *search_result(SearchWorkspace *workspace, int *order, int size);
+static void search_heap_push(SearchWorkspace *workspace, int dis, int idx);
+static SearchHeapNode search_heap_pop(SearchWorkspace *workspace);
+static int visitor_finish(void *ctx, int id, int pid);
+static int visitor_examine_edge(void *ctx, Edge *edge, DfsEdgeType type, int pid);
+static void scc_pearce_visit(Graph *graph, CSR *index, int root, int *rindex, int *frame_v,
+                             HashsetIterator **frame_iter, char *frame_root, int *stack, int *top, int *next_index,
+                             int *c);
+static void par_scc_trim(void *ctx, int tid, int threads);
+static void par_scc_reach(void *ctx, int tid, int threads);
+static void par_scc_color_init(void *ctx, int tid, int threads);
+static void par_scc_color_propagate(void *ctx, int tid, int threads);
+static void par_scc_color_collect(void *ctx, int tid, int threads);
+static void dense_uf_add(DenseUF *uf);
+static int dense_uf_find(DenseUF *uf, int x);
+static int dense_uf_union(DenseUF *uf, int x, int y);
+static void dense_uf_free(DenseUF *uf);
+static int id_uf_slot(IdUnionFind *uf, int id, int add);
+static void uf_over_edges(Graph *graph, CSR *index, DenseUF *uf);
+static IdUnionFind *fresh_connectivity(Graph *graph);
+static void free_dynamic_connectivity(DynamicConnectivity *dc);
+static void dyn_add_vertex(DynamicConnectivity *dc, int id);
+static void dyn_remove_vertex(DynamicConnectivity *dc, int id);
+static void dyn_insert_edge(DynamicConnectivity *dc, int from, int to);
+static void dyn_delete_edge(Graph *graph, int from, int to);
+static int dyn_connected(DynamicConnectivity *dc, int id1, int id2);
+static EttNode *ett_new_node(DynamicConnectivity *dc, int slot);
+static void ett_update(EttNode *x);
+static EttNode *ett_root(EttNode *x);
+static int ett_position(EttNode *x);
+static EttNode *ett_merge(EttNode *a, EttNode *b);
+static void ett_split(EttNode *t, int k, EttNode **l, EttNode **r);
+static void ett_reroot(EttNode *x);
+static void ett_add_nontree(EttNode *x, int delta);
+static void ett_link(DynamicConnectivity *dc, int from, int to);
+static void ett_cut(DynamicConnectivity *dc, TreeArc *arc);
+static int int_qsort_compare(const void *a, const void *b);
+static IncrementalMsf *create_incremental_msf(Graph *graph);
+static IncrementalMsf *fresh_msf(Graph *graph);
+static void free_incremental_msf(IncrementalMsf *msf);
+static void msf_add_vertex(IncrementalMsf *msf, int id);
+static void msf_insert_edge(IncrementalMsf *msf, int from, int to, int weight);
+static int lct_new_node(IncrementalMsf *msf, int weight, int from, int to);
+static int lct_is_root(LctNode *nodes, int x);
+static void lct_update(LctNode *nodes, int x);
+static void lct_push(LctNode *nodes, int x);
+static void lct_rotate(LctNode *nodes, int x);
+static void lct_splay(IncrementalMsf *msf, int x);
+static void lct_access(IncrementalMsf *msf, int x);
+static void lct_make_root(IncrementalMsf *msf, int x);
+static int lct_find_root(IncrementalMsf *msf, int x);
+static void lct_link(IncrementalMsf *msf, int x, int y);
+static void lct_cut(IncrementalMsf *msf, int x, int y);
+static void afforest_link(atomic_int *comp, int u, int v);
+static void afforest_neighbor_round(void *ctx, int tid, int threads);
+static void afforest_compress(void *ctx, int tid, int threads);
+static void afforest_finish(void *ctx, int tid, int threads);
+static LcaForest *create_lca_forest(int n, int *edges, int m);
+static int lca_is_ancestor(LcaForest *forest, int u, int v);
+static int lca_forest_lca(LcaForest *forest, int u, int v);
+static void free_lca_forest(LcaForest *forest);
+static WeightedArc *collect_weighted_arcs(CSR *csr, int *size);
+static void radix_sort_arcs(WeightedArc *arcs, WeightedArc *buffer, int size);
+static int partition_arcs(WeightedArc *arcs, int lo, int hi, int pivot, int inclusive);
+static void kruskal_arcs(CSR *csr, WeightedArc *arcs, WeightedArc *buffer, int size, DenseUF *uf,
+                         SpanningEdgeHandler handler, void *ctx);
+static void append_spanning_edge(void *ctx, int from, int to, int weight);
+static void indexed_heap_update(IndexedHeap *heap, int v, int key);
+static int indexed_heap_pop(IndexedHeap *heap);
+static void boruvka_min_arc(void *ctx, int tid, int threads);
+static void boruvka_hook(void *ctx, int tid, int threads);
+static void boruvka_jump(void *ctx, int tid, int threads);
+static void boruvka_relabel(void *ctx, int tid, int threads);
+static void find_strong_cuts(Graph *graph, IntArray *bridges, IntArray *points);
+static void dominators(int n, int *offset, int *adj, int *in_offset, int *in_adj, int root, int *idom);
+static int dominator_eval(int v, int *ancestor, int *label, int *semi, int *stack);
+static void flow_graph_cuts(int n, int *in_offset, int *in_adj, int *in_arc, int *idom, char *bridge, char *cut);
+static int reach_without(int n, int *offset, int *adj, int source, int removed, char *mark, int *queue);
+static FlowNetwork *create_flow_network(Graph *graph);
+static void free_flow_network(FlowNetwork *network);
+static Hashtable *flow_network_map(FlowNetwork *network);
+static int dinic(FlowNetwork *network, int s, int t, int *level);
+static int dinic_level(FlowNetwork *network, int s, int t, int *level, int *queue);
+static int dinic_blocking_flow(FlowNetwork *network, int s, int t, int *level, int *current, int *stack);
+static void push_relabel_global(PushRelabel *pr, int root, int fixed);
+static void push_relabel_enqueue(PushRelabel *pr, int v);
+static void push_relabel_discharge(PushRelabel *pr, int v, int gap);
+static StCut *global_cut(CSR *csr, char *side, int value);
+static void karger_stein_trials(void *ctx, int tid, int threads);
+static void karger_stein_recurse(KsTrial *trial, KsLevel *level);
+static void karger_stein_base(KsTrial *trial, KsLevel *level);
+static void karger_stein_contract(KsTrial *trial, KsLevel *level, int target, KsLevel *contracted);
 // ------------------Graph operations-----------------------------
 int add_graph_data(Graph *g, GraphData data) {
   int id = next_id(g);
@@ -145,6 +543,10 @@ Graph *create_graph(int directed, int weighted) {
   g->represent = r;
   g->edges = edges;
   g->last_continuous_id = 0;
+  g->connectivity = NULL;
+  g->connectivity_stale = 0;
+  g->dynamic = NULL;
+  g->msf = NULL;
   if (directed) {
     g->in_degree = new_hash_table(int_hash, int_compare);
     g->out_degree = new_hash_table(int_hash, int_compare);
@@ -160,6 +562,15 @@ int add_vertex(Graph *g, Vertex *v) {
   int ret = put_hash_table(g->represent, &v->id, v);
   if (ret == 0) return GRAPH_ERROR;
   g->vertex_size++;
+  if (g->connectivity && !g->connectivity_stale) {
+    id_uf_add(g->connectivity, v->id);
+  }
+  if (g->dynamic) {
+    dyn_add_vertex(g->dynamic, v->id);
+  }
+  if (g->msf && !g->msf->stale) {
+    msf_add_vertex(g->msf, v->id);
+  }
   return v->id;
 }
 
@@ -168,20 +579,34 @@ int add_edge(Graph *g, int from, int to, int weight) {
   if (from == to) {
     return SELF_LOOP;
   }
+  int ret;
+  int edge_size = g->edge_size;
   if (g->directed) {
     if (g->weighted) {
       // directed weighted
-      return add_edge_directed_weighted(g, from, to, weight);
+      ret = add_edge_directed_weighted(g, from, to, weight);
     } else {
-      return add_edge_directed_unweighted(g, from, to);
+      ret = add_edge_directed_unweighted(g, from, to);
     }
   } else {
     if (g->weighted) {
-      return add_edge_undirected_weighted(g, from, to, weight);
+      ret = add_edge_undirected_weighted(g, from, to, weight);
     } else {
-      return add_edge_undirected_unweighted(g, from, to);
+      ret = add_edge_undirected_unweighted(g, from, to);
     }
   }
+  if (ret == GRAPH_SUCCESS && g->connectivity && !g->connectivity_stale) {
+    id_uf_union(g->connectivity, from, to);
+  }
+  // adding an existing edge succeeds without adding anything to the forest
+  if (ret == GRAPH_SUCCESS && g->edge_size > edge_size && g->dynamic) {
+    dyn_insert_edge(g->dynamic, from, to);
+  }
+  // adding an existing edge succeeds without changing its weight
+  if (ret == GRAPH_SUCCESS && g->edge_size > edge_size && g->msf && !g->msf->stale) {
+    msf_insert_edge(g->msf, from, to, weight);
+  }
+  return ret;
 }
 
 Edge *get_edge(Graph *graph, int from, int to) {
@@ -200,6 +625,9 @@ void set_weight(Graph *graph, int from, int to, int weight) {
     edge = get_edge(graph, to, from);
     edge->weight = weight;
   }
+  if (graph->msf) {
+    graph->msf->stale = 1;
+  }
 }
 
 int vertex_count(Graph *graph) {
@@ -237,6 +665,9 @@ void free_graph(Graph *graph) {
       free_hash_table(graph->in_degree);
       free_hash_table(graph->out_degree);
     }
+    free_id_uf(graph->connectivity);
+    free_dynamic_connectivity(graph->dynamic);
+    free_incremental_msf(graph->msf);
 
     free(graph);
   }
@@ -247,6 +678,23 @@ int remove_vertex(Graph *g, int id) {
   if (!v) {
     return 0;
   }
+  if (g->dynamic) {
+    // remove edges one by one so that the spanning forest can be repaired
+    Hashset *adj = get_adj_set(g, id);
+    IntArray neighbors = {NULL, 0, 0};
+    if (adj) {
+      HashsetIterator *iter = hashset_iterator(adj);
+      while (hashset_iter_has_next(iter)) {
+        int_array_push(&neighbors, ((Edge *) set_entry_key(hashset_next_entry(iter)))->to);
+      }
+      free_hashset_iter(iter);
+    }
+    for (int i = 0; i < neighbors.size; ++i) {
+      remove_edge(g, id, neighbors.data[i]);
+    }
+    free(neighbors.data);
+    dyn_remove_vertex(g->dynamic, id);
+  }
 
   if (g->directed) {
     // remove edges starts from this vertex
@@ -276,11 +724,21 @@ int remove_vertex(Graph *g, int id) {
       free_hashset_iter(iter);
     }
   }
+  // the adjacency set is keyed by the id inside the vertex, drop it before the vertex is freed
+  Hashset *adj_set = remove_hash_table(g->edges, &id);
+  if (adj_set) {
+    register_hashset_free_functions(adj_set, free);
+    free_hash_set(adj_set);
+  }
   int ret = 0;
   remove_with_flag_hash_table(g->represent, &id, &ret);
   if (ret) {
     free(v);
     g->vertex_size--;
+    g->connectivity_stale = 1;
+    if (g->msf) {
+      g->msf->stale = 1;
+    }
     return 1;
   } else {
     return 0;
@@ -309,6 +767,13 @@ int remove_edge(Graph *g, int from, int to) {
   }
   if (ret) {
     g->edge_size--;
+    g->connectivity_stale = 1;
+    if (g->dynamic) {
+      dyn_delete_edge(g, from, to);
+    }
+    if (g->msf) {
+      g->msf->stale = 1;
+    }
   }
   return ret;
 }
@@ -367,8 +832,14 @@ Graph *reverse_graph(Graph *graph) {
     KVEntry *entry = hashtable_next_entry(iter);
     Vertex *v = table_entry_value(entry);
     add_graph_data_with_id(rg, v->id, v->data);
+  }
+  free_hashtable_iter(iter);
 
-    // reverse edges
+  // reverse edges, after all vertexes exist
+  iter = hashtable_iterator(graph->represent);
+  while (hashtable_iter_has_next(iter)) {
+    KVEntry *entry = hashtable_next_entry(iter);
+    Vertex *v = table_entry_value(entry);
     Hashset *adj = get_adj_set(graph, v->id);
     if (adj) {
       HashsetIterator *iterator = hashset_iterator(adj);
@@ -394,18 +865,17 @@ Graph *reverse_graph(Graph *graph) {
 VertexEntry *dfs_graph(Graph *graph) {
   VertexEntry *vertex_entry = new_vertex_entry(graph->vertex_size);
   if (!vertex_entry) return NULL;
-  Hashset *visited = new_hash_set(int_hash, int_compare);
-  register_hashset_free_functions(visited, free);
+  DfsEngine *engine = create_dfs_engine(graph);
   // iterate vertexes
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
-    if (!contains_in_hash_set(visited, id)) {
-      dfs(graph, visited, *id, vertex_entry);
+    if (!dfs_engine_visited(engine, *id)) {
+      dfs(engine, *id, vertex_entry);
     }
   }
   free_hashtable_iter(iter);
-  free_hash_set(visited);
+  free_dfs_engine(engine);
   return vertex_entry;
 }
 
@@ -430,21 +900,36 @@ VertexEntry *dfs_graph_nr(Graph *graph) {
 }
 
 int component_count(Graph *graph) {
+  if (graph->dynamic) {
+    return graph->dynamic->vertex_count - graph->dynamic->tree_edges;
+  }
+  if (graph->connectivity) {
+    return id_uf_count(fresh_connectivity(graph));
+  }
+  if (!graph->directed) {
+    // components do not depend on the order of traversal, a pass of union find is enough
+    CSR *index = create_csr_index(graph);
+    DenseUF uf = {NULL, NULL, 0, 0, 0};
+    uf_over_edges(graph, index, &uf);
+    int count = uf.count;
+    dense_uf_free(&uf);
+    free_csr(index);
+    return count;
+  }
   int c = 0;
-  Hashset *visited = new_hash_set(int_hash, int_compare);
-  register_hashset_free_functions(visited, free);
+  DfsEngine *engine = create_dfs_engine(graph);
   // iterate vertexes
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
-    if (!contains_in_hash_set(visited, id)) {
-      dfs_visit(graph, visited, *id);
+    if (!dfs_engine_visited(engine, *id)) {
+      dfs_visit(engine, *id);
       c++;
     }
   }
 
   free_hashtable_iter(iter);
-  free_hash_set(visited);
+  free_dfs_engine(engine);
   return c;
 }
 
@@ -452,17 +937,19 @@ Hashtable *graph_components(Graph *graph) {
   int c = 0;
   Hashtable *visited = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(visited, free, free);
+  DfsEngine *engine = create_dfs_engine(graph);
   // iterate vertexes
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
     if (!contains_in_hash_table(visited, id)) {
-      dfs_cid(graph, visited, *id, c);
+      dfs_cid(engine, visited, *id, c);
       c++;
     }
   }
 
   free_hashtable_iter(iter);
+  free_dfs_engine(engine);
 
   Hashtable *cmap = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(cmap, free, (HashtableValueFreeFunc) free_arraylist);
@@ -494,7 +981,9 @@ Hashtable *single_source_path(Graph *graph, int s, GraphOrd ord) {
   Hashtable *pre = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(pre, free, free);
   if (ord == DFS) {
-    dfs_par(graph, pre, s, s);
+    DfsEngine *engine = create_dfs_engine(graph);
+    dfs_par(engine, pre, s);
+    free_dfs_engine(engine);
   } else {
     bfs_par(graph, pre, s, s);
   }
@@ -521,9 +1010,17 @@ int has_path(Graph *graph, int v1, int v2) {
   if (v1 == v2) {
     return 0;
   }
+  if (graph->dynamic) {
+    return dyn_connected(graph->dynamic, v1, v2);
+  }
+  if (graph->connectivity) {
+    return id_uf_same_set(fresh_connectivity(graph), v1, v2);
+  }
   Hashtable *pre = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(pre, free, free);
-  int ret = dfs_cmp(graph, pre, v1, v1, v2);
+  DfsEngine *engine = create_dfs_engine(graph);
+  int ret = dfs_cmp(engine, pre, v1, v2);
+  free_dfs_engine(engine);
   free_hash_table(pre);
   return ret;
 }
@@ -537,7 +1034,9 @@ LinkedList *one_path(Graph *graph, int v1, int v2) {
   }
   Hashtable *pre = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(pre, free, free);
-  int ret = dfs_cmp(graph, pre, v1, v1, v2);
+  DfsEngine *engine = create_dfs_engine(graph);
+  int ret = dfs_cmp(engine, pre, v1, v2);
+  free_dfs_engine(engine);
   if (!ret) {
     free_hash_table(pre);
     return NULL;
@@ -612,13 +1111,14 @@ int is_bipartite(Graph *graph) {
   // <id,color>, color:0,1
   Hashtable *visited = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(visited, free, free);
+  DfsEngine *engine = create_dfs_engine(graph);
 
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   int ret = 1;
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
     if (!contains_in_hash_table(visited, id)) {
-      if (!dfs_bipartite_test(graph, visited, *id, 0)) {
+      if (!dfs_bipartite_test(engine, visited, *id, 0)) {
         ret = 0;
         goto clean_return;
       }
@@ -627,6 +1127,7 @@ int is_bipartite(Graph *graph) {
 
   clean_return:
   free_hashtable_iter(iter);
+  free_dfs_engine(engine);
   free_hash_table(visited);
   return ret;
 }
@@ -653,68 +1154,42 @@ VertexEntry *bfs_graph(Graph *graph) {
 
 LinkedList *find_bridge(Graph *graph) {
   if (graph->directed) {
-    // TODO
-    assert(0);
+    IntArray bridges = {NULL, 0, 0};
+    find_strong_cuts(graph, &bridges, NULL);
+    LinkedList *result = new_linked_list();
+    for (int i = 0; i < bridges.size; i += 2) {
+      append_list(result, get_edge(graph, bridges.data[i], bridges.data[i + 1]));
+    }
+    free(bridges.data);
+    return result;
   } else {
-    Hashset *visited = new_hash_set(int_hash, int_compare);
-    register_hashset_free_functions(visited, free);
-
-    Hashtable *ord = new_hash_table(int_hash, int_compare);
-    register_hashtable_free_functions(ord, free, free);
-
-    Hashtable *low = new_hash_table(int_hash, int_compare);
-    register_hashtable_free_functions(low, free, free);
-
-    int visited_count = 0;
+    Biconnectivity *bc = biconnectivity(graph);
     LinkedList *result = new_linked_list();
-
-    HashtableIterator *iter = hashtable_iterator(graph->represent);
-
-    while (hashtable_iter_has_next(iter)) {
-      int *id = table_entry_key(hashtable_next_entry(iter));
-      if (!contains_in_hash_set(visited, id)) {
-        find_bridge_ud(graph, visited, ord, low, visited_count, *id, *id, result);
-      }
+    for (int i = 0; i < bc->bridge_size; ++i) {
+      append_list(result, get_edge(graph, bc->bridges[2 * i], bc->bridges[2 * i + 1]));
     }
-
-    free_hashtable_iter(iter);
-    free_hash_set(visited);
-    free_hash_table(ord);
-    free_hash_table(low);
+    free_biconnectivity(bc);
     return result;
   }
 }
 
 LinkedList *find_cut_point(Graph *graph) {
   if (graph->directed) {
-    // TODO
-    assert(0);
+    IntArray points = {NULL, 0, 0};
+    find_strong_cuts(graph, NULL, &points);
+    LinkedList *result = new_linked_list();
+    for (int i = 0; i < points.size; ++i) {
+      append_list(result, new_id(points.data[i]));
+    }
+    free(points.data);
+    return result;
   } else {
-    Hashset *visited = new_hash_set(int_hash, int_compare);
-    register_hashset_free_functions(visited, free);
-
-    Hashtable *ord = new_hash_table(int_hash, int_compare);
-    register_hashtable_free_functions(ord, free, free);
-
-    Hashtable *low = new_hash_table(int_hash, int_compare);
-    register_hashtable_free_functions(low, free, free);
-
-    int visited_count = 0;
+    Biconnectivity *bc = biconnectivity(graph);
     LinkedList *result = new_linked_list();
-
-    HashtableIterator *iter = hashtable_iterator(graph->represent);
-
-    while (hashtable_iter_has_next(iter)) {
-      int *id = table_entry_key(hashtable_next_entry(iter));
-      if (!contains_in_hash_set(visited, id)) {
-        find_cut_point_ud(graph, visited, ord, low, visited_count, *id, *id, result);
-      }
+    for (int i = 0; i < bc->cut_point_size; ++i) {
+      append_list(result, new_id(bc->cut_points[i]));
     }
-
-    free_hashtable_iter(iter);
-    free_hash_set(visited);
-    free_hash_table(ord);
-    free_hash_table(low);
+    free_biconnectivity(bc);
     return result;
   }
 }
@@ -834,92 +1309,193 @@ LinkedList *hierholzer_euler_loop(Graph *graph) {
 }
 
 LinkedList *kruskal_mst(Graph *graph) {
-  assert(!graph->directed);
-  assert(graph->weighted);
-  int cc = component_count(graph);
-  if (cc > 1) {
+  return filter_kruskal_mst(graph);
+}
+
+LinkedList *filter_kruskal_mst(Graph *graph) {
+  LinkedList *mst = new_linked_list();
+  if (kruskal_msf(graph, append_spanning_edge, mst) > 1) {
+    free_linked_list(mst, free);
     return NULL;
   }
-  LinkedList *mst = new_linked_list();
-  // sort the edges
-  ArrayList *edge_list = new_arraylist(0);
-  HashtableIterator *iter = hashtable_iterator(graph->edges);
-  while (hashtable_iter_has_next(iter)) {
-    Hashset *edge = table_entry_value(hashtable_next_entry(iter));
-    HashsetIterator *iterator = hashset_iterator(edge);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *e = set_entry_key(hashset_next_entry(iterator));
-      if (e->from < e->to) {
-        append_arraylist(edge_list, e);
+  return mst;
+}
+
+int kruskal_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx) {
+  assert(!graph->directed);
+  assert(graph->weighted);
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  int m;
+  WeightedArc *arcs = collect_weighted_arcs(csr, &m);
+  WeightedArc *buffer = malloc(sizeof(WeightedArc) * (m + 1));
+  DenseUF uf = {NULL, NULL, 0, 0, 0};
+  for (int v = 0; v < n; ++v) {
+    dense_uf_add(&uf);
+  }
+  unsigned int seed = 2166136261u;
+  // ranges [lo, hi) of arcs left, the lightest range on top
+  IntArray ranges = {NULL, 0, 0};
+  int_array_push(&ranges, 0);
+  int_array_push(&ranges, m);
+  while (ranges.size > 0 && uf.count > 1) {
+    int hi = ranges.data[--ranges.size];
+    int lo = ranges.data[--ranges.size];
+    // filter out arcs already inside one tree, all lighter arcs are processed
+    int k = lo;
+    for (int i = lo; i < hi; ++i) {
+      if (dense_uf_find(&uf, arcs[i].from) != dense_uf_find(&uf, arcs[i].to)) arcs[k++] = arcs[i];
+    }
+    hi = k;
+    if (hi - lo <= FILTER_KRUSKAL_BASE) {
+      kruskal_arcs(csr, arcs + lo, buffer + lo, hi - lo, &uf, handler, ctx);
+      continue;
+    }
+    seed = seed * 1103515245u + 12345u;
+    int pivot = arcs[lo + (seed >> 8) % (hi - lo)].weight;
+    int mid = partition_arcs(arcs, lo, hi, pivot, 0);
+    if (mid == lo) {
+      // pivot is the lightest weight
+      mid = partition_arcs(arcs, lo, hi, pivot, 1);
+      if (mid == hi) {
+        kruskal_arcs(csr, arcs + lo, buffer + lo, hi - lo, &uf, handler, ctx);
+        continue;
       }
     }
-    free_hashset_iter(iterator);
-  }
-  free_hashtable_iter(iter);
-  sort_arraylist(edge_list, edge_weight_compare);
-
-  // TODO size of union find should be the max id of the graph because id can be designated as wish
-  // however, usually id of vertex is auto-generated sequentially so the size of vertexes is the union find size.
-  UnionFind *uf = create_uf(graph->vertex_size);
-  for (int i = 0; i < edge_list->size; ++i) {
-    Edge *edge = get_data_arraylist(edge_list, i);
-    int f = edge->from;
-    int t = edge->to;
-    if (!uf_same_set(uf, f, t)) {
-      append_list(mst, create_edge(f, t, edge->weight));
-      uf_union(uf, f, t);
-    }
-  }
-  free_arraylist(edge_list);
-  free_uf(uf);
-  return mst;
+    int_array_push(&ranges, mid);
+    int_array_push(&ranges, hi);
+    int_array_push(&ranges, lo);
+    int_array_push(&ranges, mid);
+  }
+  int trees = uf.count;
+  free(ranges.data);
+  free(arcs);
+  free(buffer);
+  dense_uf_free(&uf);
+  free_csr(csr);
+  return trees;
 }
 
-LinkedList *prim_mst(Graph *graph) {
+typedef struct Boruvka {
+  WeightedArc *arcs;
+  int arc_size;
+  int n;
+  int *comp;                    // component of every vertex, the slot of its root
+  _Atomic uint64_t *best;       // lightest arc leaving every component as (weight, arc) in 64 bits
+  atomic_int *next;             // component a root is hooked to, itself if not hooked
+  atomic_int hooked;
+  atomic_int cursor;
+  IntArray *local;              // tree arcs found by each thread as (from, to, weight)
+} Boruvka;
+
+LinkedList *boruvka_msf(Graph *graph, int threads) {
   assert(!graph->directed);
   assert(graph->weighted);
-  int cc = component_count(graph);
-  if (cc > 1) {
-    return NULL;
+  threads = resolve_threads(threads);
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  Boruvka bv = {.n=n};
+  bv.arcs = collect_weighted_arcs(csr, &bv.arc_size);
+  bv.comp = malloc(sizeof(int) * (n + 1));
+  bv.best = malloc(sizeof(_Atomic uint64_t) * (n + 1));
+  bv.next = malloc(sizeof(atomic_int) * (n + 1));
+  bv.local = calloc(threads, sizeof(IntArray));
+  for (int v = 0; v < n; ++v) {
+    bv.comp[v] = v;
+    atomic_init(&bv.best[v], UINT64_MAX);
+    atomic_init(&bv.next[v], v);
+  }
+  int vertex_threads = n < PAR_GRAIN ? 1 : threads;
+  while (1) {
+    atomic_store(&bv.cursor, 0);
+    parallel_run(bv.arc_size < PAR_GRAIN ? 1 : threads, boruvka_min_arc, &bv);
+    atomic_store(&bv.hooked, 0);
+    atomic_store(&bv.cursor, 0);
+    parallel_run(vertex_threads, boruvka_hook, &bv);
+    if (!atomic_load(&bv.hooked)) break;
+    atomic_store(&bv.cursor, 0);
+    parallel_run(vertex_threads, boruvka_jump, &bv);
+    atomic_store(&bv.cursor, 0);
+    parallel_run(vertex_threads, boruvka_relabel, &bv);
+    // drop the arcs inside one component, later rounds only scan the arcs left. the order is kept
+    int size = 0;
+    for (int i = 0; i < bv.arc_size; ++i) {
+      if (bv.comp[bv.arcs[i].from] != bv.comp[bv.arcs[i].to]) {
+        bv.arcs[size++] = bv.arcs[i];
+      }
+    }
+    bv.arc_size = size;
   }
-  LinkedList *mst = new_linked_list();
-  PriorityQueue *pq = create_pq(edge_weight_compare_pq);
-  Hashset *visited = new_hash_set(int_hash, int_compare);
 
-  int v = pick_one_id(graph);
-  put_hash_set(visited, &v);
-  Hashset *ve = get_adj_set(graph, v);
+  LinkedList *msf = new_linked_list();
+  for (int t = 0; t < threads; ++t) {
+    int *data = bv.local[t].data;
+    for (int i = 0; i < bv.local[t].size; i += 3) {
+      append_list(msf, create_edge(csr->ids[data[i]], csr->ids[data[i + 1]], data[i + 2]));
+    }
+    free(bv.local[t].data);
+  }
+  free(bv.local);
+  free(bv.arcs);
+  free(bv.comp);
+  free(bv.best);
+  free(bv.next);
+  free_csr(csr);
+  return msf;
+}
 
-  HashsetIterator *iterator = hashset_iterator(ve);
-  while (hashset_iter_has_next(iterator)) {
-    Edge *e = set_entry_key(hashset_next_entry(iterator));
-    pq_enqueue(pq, e);
+LinkedList *prim_mst(Graph *graph) {
+  LinkedList *mst = new_linked_list();
+  if (prim_msf(graph, append_spanning_edge, mst) > 1) {
+    free_linked_list(mst, free);
+    return NULL;
   }
-  free_hashset_iter(iterator);
-
-  while (!is_pq_empty(pq)) {
-    Edge *min_edge = pq_dequeue(pq);
-    if (contains_in_hash_set(visited, &min_edge->to)
-        && contains_in_hash_set(visited, &min_edge->from)) {
-      continue;
-    }
-    append_list(mst, create_edge(min_edge->from, min_edge->to, min_edge->weight));
-    int *new_v = contains_in_hash_set(visited, &min_edge->from) ? &min_edge->to : &min_edge->from;
-    put_hash_set(visited, new_v);
-    ve = get_adj_set(graph, *new_v);
+  return mst;
+}
 
-    iterator = hashset_iterator(ve);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_set(visited, &edge->to)) {
-        pq_enqueue(pq, edge);
+int prim_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx) {
+  assert(!graph->directed);
+  assert(graph->weighted);
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  // eager prim: a vertex is in the heap once, keyed by its lightest edge to the tree
+  IndexedHeap heap = {.size=0};
+  heap.heap = malloc(sizeof(int) * (n + 1));
+  heap.pos = malloc(sizeof(int) * (n + 1));
+  heap.key = malloc(sizeof(int) * (n + 1));
+  int *from = malloc(sizeof(int) * (n + 1));
+  uint64_t *visited = calloc(n / 64 + 1, sizeof(uint64_t));
+  for (int v = 0; v < n; ++v) {
+    heap.pos[v] = -1;
+  }
+  int trees = 0;
+  for (int r = 0; r < n; ++r) {
+    if (visited[r >> 6] >> (r & 63) & 1) continue;
+    // a new tree
+    trees++;
+    from[r] = -1;
+    indexed_heap_update(&heap, r, 0);
+    while (heap.size > 0) {
+      int v = indexed_heap_pop(&heap);
+      visited[v >> 6] |= (uint64_t) 1 << (v & 63);
+      if (from[v] >= 0) handler(ctx, csr->ids[from[v]], csr->ids[v], heap.key[v]);
+      for (int e = csr->offset[v]; e < csr->offset[v + 1]; ++e) {
+        int w = csr->adj[e];
+        if (visited[w >> 6] >> (w & 63) & 1) continue;
+        if (heap.pos[w] < 0 || csr->weight[e] < heap.key[w]) {
+          from[w] = v;
+          indexed_heap_update(&heap, w, csr->weight[e]);
+        }
       }
     }
-    free_hashset_iter(iterator);
   }
-  free_pq(pq, NULL);
-  free_hash_set(visited);
-  return mst;
+  free(heap.heap);
+  free(heap.pos);
+  free(heap.key);
+  free(from);
+  free(visited);
+  free_csr(csr);
+  return trees;
 }
 
 // for dijkstra algorithm
@@ -1467,15 +2043,17 @@ Hashtable *scc_kosaraju(Graph *graph) {
   int cid = 0;
   Hashtable *visited = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(visited, free, free);
+  DfsEngine *engine = create_dfs_engine(graph);
 
   // dfs original graph
   for (int i = entry->size - 1; i >= 0; --i) {
     int id = entry->id_list[i];
     if (!contains_in_hash_table(visited, &id)) {
-      dfs_cid(graph, visited, id, cid);
+      dfs_cid(engine, visited, id, cid);
       cid++;
     }
   }
+  free_dfs_engine(engine);
   free_vertex_entry(entry);
   register_hashtable_free_functions(strongly_components, free, NULL);
 
@@ -1560,24 +2138,281 @@ Hashtable *max_flow(Graph *graph, int source, int to, int *max_flow) {
   return flow;
 }
 
+Hashtable *dinic_max_flow(Graph *graph, int source, int to, int *max_flow) {
+  assert(graph->directed);
+  assert(graph->weighted);
+  assert(graph->vertex_size > 1);
+  assert(source != to);
+  assert(has_vertex(graph, source));
+  assert(has_vertex(graph, to));
+
+  FlowNetwork *network = create_flow_network(graph);
+  int *level = malloc(sizeof(int) * network->n);
+  *max_flow = dinic(network, csr_slot(network->csr, source), csr_slot(network->csr, to), level);
+  free(level);
+  Hashtable *flow = flow_network_map(network);
+  free_flow_network(network);
+  return flow;
+}
+
+Hashtable *push_relabel_max_flow(Graph *graph, int source, int to, int *max_flow) {
+  assert(graph->directed);
+  assert(graph->weighted);
+  assert(graph->vertex_size > 1);
+  assert(source != to);
+  assert(has_vertex(graph, source));
+  assert(has_vertex(graph, to));
+
+  FlowNetwork *network = create_flow_network(graph);
+  int n = network->n;
+  PushRelabel pr;
+  pr.network = network;
+  pr.s = csr_slot(network->csr, source);
+  pr.t = csr_slot(network->csr, to);
+  pr.height = malloc(sizeof(int) * n);
+  pr.excess = calloc(n, sizeof(long));
+  pr.current = malloc(sizeof(int) * n);
+  pr.count = malloc(sizeof(int) * n);
+  pr.queue = malloc(sizeof(int) * n);
+  pr.head = 0;
+  pr.size = 0;
+  pr.active = calloc(n, sizeof(char));
+  pr.relabels = 0;
+
+  // saturate the arcs out of s
+  pr.height[pr.s] = n;
+  pr.height[pr.t] = 0;
+  for (int i = network->offset[pr.s]; i < network->offset[pr.s + 1]; ++i) {
+    int e = network->arc[i];
+    int f = network->cap[e];
+    if (f == 0) continue;
+    network->cap[e] = 0;
+    network->cap[e ^ 1] += f;
+    pr.excess[network->head[e]] += f;
+    pr.excess[pr.s] -= f;
+  }
+  // first phase moves as much excess as possible to t, vertexes on height n can not reach t any more
+  push_relabel_global(&pr, pr.t, pr.s);
+  for (int v = 0; v < n; ++v) push_relabel_enqueue(&pr, v);
+  while (pr.size > 0) {
+    int v = pr.queue[pr.head];
+    pr.head = (pr.head + 1) % n;
+    pr.size--;
+    pr.active[v] = 0;
+    if (pr.height[v] >= n) continue;
+    push_relabel_discharge(&pr, v, 1);
+    if (pr.relabels >= n) push_relabel_global(&pr, pr.t, pr.s);
+  }
+  // second phase returns the excess left to s, so that the preflow becomes a flow
+  push_relabel_global(&pr, pr.s, pr.t);
+  for (int v = 0; v < n; ++v) push_relabel_enqueue(&pr, v);
+  while (pr.size > 0) {
+    int v = pr.queue[pr.head];
+    pr.head = (pr.head + 1) % n;
+    pr.size--;
+    pr.active[v] = 0;
+    push_relabel_discharge(&pr, v, 0);
+  }
+  *max_flow = (int) pr.excess[pr.t];
+
+  free(pr.height);
+  free(pr.excess);
+  free(pr.current);
+  free(pr.count);
+  free(pr.queue);
+  free(pr.active);
+  Hashtable *flow = flow_network_map(network);
+  free_flow_network(network);
+  return flow;
+}
+
+StCut *min_st_cut(Graph *graph, int source, int to) {
+  assert(graph->directed);
+  assert(graph->weighted);
+  assert(graph->vertex_size > 1);
+  assert(source != to);
+  assert(has_vertex(graph, source));
+  assert(has_vertex(graph, to));
+
+  FlowNetwork *network = create_flow_network(graph);
+  CSR *csr = network->csr;
+  int n = csr->n;
+  int *level = malloc(sizeof(int) * n);
+  StCut *cut = malloc(sizeof(StCut));
+  cut->value = dinic(network, csr_slot(csr, source), csr_slot(csr, to), level);
+  cut->size = n;
+  cut->id_list = malloc(sizeof(int) * n);
+  memcpy(cut->id_list, csr->ids, sizeof(int) * n);
+  cut->side = calloc((n + 63) / 64, sizeof(uint64_t));
+  int v, k;
+  for (v = 0; v < n; ++v) {
+    if (level[v] >= 0) cut->side[v >> 6] |= 1ULL << (v & 63);
+  }
+  // edges leaving the source side, all saturated
+  IntArray edges = {NULL, 0, 0};
+  for (v = 0; v < n; ++v) {
+    if (level[v] < 0) continue;
+    for (k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      if (level[csr->adj[k]] >= 0) continue;
+      int_array_push(&edges, csr->ids[v]);
+      int_array_push(&edges, csr->ids[csr->adj[k]]);
+    }
+  }
+  cut->cut_edges = edges.data;
+  cut->cut_edge_size = edges.size / 2;
+  free(level);
+  free_flow_network(network);
+  return cut;
+}
+
+void free_st_cut(StCut *cut) {
+  if (cut) {
+    free(cut->id_list);
+    free(cut->side);
+    free(cut->cut_edges);
+    free(cut);
+  }
+}
+
+StCut *stoer_wagner_min_cut(Graph *graph) {
+  if (graph->directed || !graph->weighted || graph->vertex_size < 2) return NULL;
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  int *rep = malloc(sizeof(int) * n); // merged vertex every slot belongs to
+  int *first = malloc(sizeof(int) * n);
+  int *last = malloc(sizeof(int) * n);
+  int *next = malloc(sizeof(int) * n);
+  char *side = calloc(n, sizeof(char));
+  IndexedHeap heap = {malloc(sizeof(int) * n), malloc(sizeof(int) * n), malloc(sizeof(int) * n), 0};
+  int v, k, x;
+  for (v = 0; v < n; ++v) {
+    rep[v] = first[v] = last[v] = v;
+    next[v] = -1;
+    heap.pos[v] = -1;
+  }
+  int best = INT_MAX;
+  for (int phase = n; phase > 1; --phase) {
+    // maximum adjacency order: the next vertex is the one most tightly connected to the ones before it,
+    // keys are negated for the min heap
+    for (v = 0; v < n; ++v) {
+      if (rep[v] == v) indexed_heap_update(&heap, v, 0);
+    }
+    int s = -1, t = -1;
+    while (heap.size > 0) {
+      int u = indexed_heap_pop(&heap);
+      s = t;
+      t = u;
+      for (x = first[u]; x >= 0; x = next[x]) {
+        for (k = csr->offset[x]; k < csr->offset[x + 1]; ++k) {
+          int w = rep[csr->adj[k]];
+          if (heap.pos[w] >= 0) indexed_heap_update(&heap, w, heap.key[w] - csr->weight[k]);
+        }
+      }
+    }
+    // the cut of the phase separates t from the rest
+    if (-heap.key[t] < best) {
+      best = -heap.key[t];
+      memset(side, 0, n);
+      for (x = first[t]; x >= 0; x = next[x]) side[x] = 1;
+    }
+    for (x = first[t]; x >= 0; x = next[x]) rep[x] = s;
+    next[last[s]] = first[t];
+    last[s] = last[t];
+  }
+  StCut *cut = global_cut(csr, side, best);
+  free(rep);
+  free(first);
+  free(last);
+  free(next);
+  free(side);
+  free(heap.heap);
+  free(heap.pos);
+  free(heap.key);
+  free_csr(csr);
+  return cut;
+}
+
+StCut *karger_stein_min_cut(Graph *graph, int trials, int threads, unsigned int seed) {
+  if (graph->directed || !graph->weighted || graph->vertex_size < 2) return NULL;
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  int size;
+  WeightedArc *arcs = collect_weighted_arcs(csr, &size);
+  int m = 0;
+  for (int i = 0; i < size; ++i) {
+    if (arcs[i].weight > 0) arcs[m++] = arcs[i];
+  }
+  char *side = calloc(n, sizeof(char));
+  // a graph falling apart without zero weight edges has a cut of 0, which contraction would never reach
+  DenseUF uf = {NULL, NULL, 0, 0, 0};
+  for (int v = 0; v < n; ++v) dense_uf_add(&uf);
+  for (int i = 0; i < m; ++i) dense_uf_union(&uf, arcs[i].from, arcs[i].to);
+  if (uf.count > 1) {
+    int root = dense_uf_find(&uf, 0);
+    for (int v = 0; v < n; ++v) side[v] = dense_uf_find(&uf, v) == root;
+    dense_uf_free(&uf);
+    StCut *cut = global_cut(csr, side, 0);
+    free(side);
+    free(arcs);
+    free_csr(csr);
+    return cut;
+  }
+  dense_uf_free(&uf);
+
+  if (trials <= 0) {
+    // a trial succeeds with probability 1/logV, logV^2 trials miss the minimum cut with probability 1/V
+    int lg = 1;
+    while ((1 << lg) < n) lg++;
+    trials = lg * lg;
+  }
+  threads = resolve_threads(threads);
+  if (threads > trials) threads = trials;
+  KargerStein ks = {.arcs=arcs, .arc_size=m, .n=n, .trials=trials, .seed=seed};
+  atomic_init(&ks.cursor, 0);
+  ks.best = malloc(sizeof(int) * threads);
+  ks.best_trial = malloc(sizeof(int) * threads);
+  ks.side = malloc(sizeof(char *) * threads);
+  for (int t = 0; t < threads; ++t) {
+    ks.best[t] = INT_MAX;
+    ks.best_trial[t] = trials;
+    ks.side[t] = calloc(n, sizeof(char));
+  }
+  parallel_run(threads, karger_stein_trials, &ks);
+  int win = 0;
+  for (int t = 1; t < threads; ++t) {
+    if (ks.best[t] < ks.best[win] || (ks.best[t] == ks.best[win] && ks.best_trial[t] < ks.best_trial[win])) win = t;
+  }
+  StCut *cut = global_cut(csr, ks.side[win], ks.best[win]);
+  for (int t = 0; t < threads; ++t) free(ks.side[t]);
+  free(ks.side);
+  free(ks.best);
+  free(ks.best_trial);
+  free(side);
+  free(arcs);
+  free_csr(csr);
+  return cut;
+}
+
 int bipartite_matching(Graph *graph) {
   assert(!graph->directed);
   // <id,color>, color:0,1
   Hashtable *visited = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(visited, free, free);
 
+  DfsEngine *engine = create_dfs_engine(graph);
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   int is_bipartite = 1;
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
     if (!contains_in_hash_table(visited, id)) {
-      if (!dfs_bipartite_test(graph, visited, *id, 0)) {
+      if (!dfs_bipartite_test(engine, visited, *id, 0)) {
         is_bipartite = 0;
         break;
       }
     }
   }
   free_hashtable_iter(iter);
+  free_dfs_engine(engine);
   if (is_bipartite == 0) {
     free_hash_table(visited);
     assert(is_bipartite == 1);
@@ -1644,18 +2479,20 @@ int hungarian_matching(Graph *graph) {
   Hashtable *color = new_hash_table(int_hash, int_compare);
   register_hashtable_free_functions(color, free, free);
 
+  DfsEngine *engine = create_dfs_engine(graph);
   HashtableIterator *iter = hashtable_iterator(graph->represent);
   int is_bipartite = 1;
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
     if (!contains_in_hash_table(color, id)) {
-      if (!dfs_bipartite_test(graph, color, *id, 0)) {
+      if (!dfs_bipartite_test(engine, color, *id, 0)) {
         is_bipartite = 0;
         break;
       }
     }
   }
   free_hashtable_iter(iter);
+  free_dfs_engine(engine);
   if (is_bipartite == 0) {
     free_hash_table(color);
     assert(is_bipartite == 1);
@@ -1682,32 +2519,1057 @@ int hungarian_matching(Graph *graph) {
   free_hash_table(color);
   return maxflow;
 }
-//---------------Graph Algorithms-----------------
+Hashtable *direction_optimizing_bfs(Graph *graph, int s) {
+  if (!has_vertex(graph, s)) {
+    return NULL;
+  }
+  CSR *csr = create_csr(graph);
+  csr_build_in(csr);
+  int n = csr->n;
+  int words = (n + 63) / 64;
+  int *parent = malloc(sizeof(int) * n);
+  int *frontier = malloc(sizeof(int) * n);
+  int *next = malloc(sizeof(int) * n);
+  uint64_t *frontier_bits = calloc(words, sizeof(uint64_t));
+  uint64_t *next_bits = calloc(words, sizeof(uint64_t));
+  for (int i = 0; i < n; ++i) {
+    parent[i] = -1;
+  }
+  int src = csr_slot(csr, s);
+  parent[src] = src;
+  frontier[0] = src;
+  int frontier_size = 1;
+  int bottom_up = 0;
+  // arcs to check from the frontier (m_f) and from unexplored vertexes (m_u)
+  long long edges_frontier = csr->offset[src + 1] - csr->offset[src];
+  long long edges_unexplored = csr->m - edges_frontier;
+
+  while (frontier_size > 0) {
+    if (!bottom_up && edges_frontier > edges_unexplored / DO_BFS_ALPHA) {
+      // frontier is large: switch to bottom-up with a bitmap frontier
+      memset(frontier_bits, 0, sizeof(uint64_t) * words);
+      for (int i = 0; i < frontier_size; ++i) {
+        frontier_bits[frontier[i] >> 6] |= 1ULL << (frontier[i] & 63);
+      }
+      bottom_up = 1;
+    }
+    int last_size = frontier_size;
+    if (bottom_up) {
+      memset(next_bits, 0, sizeof(uint64_t) * words);
+      frontier_size = bfs_bottom_up_step(csr, parent, frontier_bits, next_bits);
+      uint64_t *tmp = frontier_bits;
+      frontier_bits = next_bits;
+      next_bits = tmp;
+      if (frontier_size < last_size && frontier_size < n / DO_BFS_BETA) {
+        // frontier is shrinking: switch back to top-down with a queue frontier
+        frontier_size = 0;
+        for (int v = 0; v < n; ++v) {
+          if (frontier_bits[v >> 6] & (1ULL << (v & 63))) {
+            frontier[frontier_size++] = v;
+          }
+        }
+        bottom_up = 0;
+      }
+    } else {
+      frontier_size = bfs_top_down_step(csr, parent, frontier, frontier_size, next);
+      int *tmp = frontier;
+      frontier = next;
+      next = tmp;
+    }
+    edges_frontier = 0;
+    if (bottom_up) {
+      for (int v = 0; v < n; ++v) {
+        if (frontier_bits[v >> 6] & (1ULL << (v & 63))) {
+          edges_frontier += csr->offset[v + 1] - csr->offset[v];
+        }
+      }
+    } else {
+      for (int i = 0; i < frontier_size; ++i) {
+        edges_frontier += csr->offset[frontier[i] + 1] - csr->offset[frontier[i]];
+      }
+    }
+    edges_unexplored -= edges_frontier;
+  }
 
-//--------------- static functions ----------------------
-static int bfs_hungarian(Graph *graph, Hashtable *matching, int id) {
-  Hashtable *pre = new_hash_table(int_hash, int_compare);
-  register_hashtable_free_functions(pre, free, free);
-  Dqueue *queue = new_dqueue();
+  Hashtable *pre = slot_parent_to_map(csr, parent);
+  free(parent);
+  free(frontier);
+  free(next);
+  free(frontier_bits);
+  free(next_bits);
+  free_csr(csr);
+  return pre;
+}
+// shared state of one level of the parallel bfs
+typedef struct ParBfs {
+  CSR *csr;
+  atomic_int *parent;
+  int *frontier;
+  int frontier_size;
+  atomic_int cursor; // next unclaimed position of frontier
+  IntArray *local; // next frontier found by each thread
+} ParBfs;
+
+VertexEntry *bfs_graph_par(Graph *graph, int threads) {
+  threads = resolve_threads(threads);
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  VertexEntry *vertex_entry = new_vertex_entry(n);
+  if (!vertex_entry) {
+    free_csr(csr);
+    return NULL;
+  }
+  atomic_int *parent = malloc(sizeof(atomic_int) * (n + 1));
+  int *frontier = malloc(sizeof(int) * (n + 1));
+  IntArray *local = calloc(threads, sizeof(IntArray));
+  for (int i = 0; i < n; ++i) {
+    atomic_init(&parent[i], -1);
+  }
+  ParBfs bfs = {.csr=csr, .parent=parent, .frontier=frontier, .local=local};
+
+  for (int root = 0; root < n; ++root) {
+    if (atomic_load(&parent[root]) >= 0) continue;
+    atomic_store(&parent[root], root);
+    frontier[0] = root;
+    bfs.frontier_size = 1;
+    while (bfs.frontier_size > 0) {
+      for (int i = 0; i < bfs.frontier_size; ++i) {
+        vertex_entry->id_list[vertex_entry->size++] = csr->ids[frontier[i]];
+      }
+      atomic_store(&bfs.cursor, 0);
+      // spawning threads does not pay off for small frontiers
+      int level_threads = bfs.frontier_size < PAR_GRAIN ? 1 : threads;
+      parallel_run(level_threads, par_bfs_level, &bfs);
+      // merge local frontiers
+      int size = 0;
+      for (int t = 0; t < level_threads; ++t) {
+        if (local[t].size == 0) continue;
+        memcpy(frontier + size, local[t].data, sizeof(int) * local[t].size);
+        size += local[t].size;
+      }
+      bfs.frontier_size = size;
+    }
+  }
 
-  put_hash_table(pre, new_id(id), new_id(id));
-  dqueue_push_tail(queue, &id);
-  while (!dqueue_is_empty(queue)) {
-    int *cur = dqueue_pop_head(queue);
-    Hashset *adj = get_adj_set(graph, *cur);
-    HashsetIterator *iter = hashset_iterator(adj);
-    while (hashset_iter_has_next(iter)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iter));
-      int next = get_edge_to(edge);
-      if (!contains_in_hash_table(pre, &next)) {
-        // find a matched vertex on right side
-        if (contains_in_hash_table(matching, &next)) {
-          put_hash_table(pre, new_id(next), new_id(*cur));
-          int *match = get_hash_table(matching, &next);
-          put_hash_table(pre, new_id(*match), new_id(next));
-          dqueue_push_tail(queue, match);
-        } else {
-          // find the end of augmenting path
+  for (int t = 0; t < threads; ++t) {
+    free(local[t].data);
+  }
+  free(local);
+  free(frontier);
+  free(parent);
+  free_csr(csr);
+  return vertex_entry;
+}
+HopMatrix *multi_source_bfs(Graph *graph, int *sources, int source_size) {
+  for (int i = 0; i < source_size; ++i) {
+    if (!has_vertex(graph, sources[i])) {
+      return NULL;
+    }
+  }
+  HopMatrix *matrix = malloc(sizeof(HopMatrix));
+  if (!matrix) return NULL;
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  matrix->size = n;
+  matrix->source_size = source_size;
+  matrix->id_list = malloc(sizeof(int) * (n + 1));
+  memcpy(matrix->id_list, csr->ids, sizeof(int) * n);
+  matrix->source_list = malloc(sizeof(int) * (source_size + 1));
+  matrix->hops = malloc(sizeof(int) * ((size_t) source_size * n + 1));
+  int *slots = malloc(sizeof(int) * (source_size + 1));
+  for (int i = 0; i < source_size; ++i) {
+    matrix->source_list[i] = sources[i];
+    slots[i] = csr_slot(csr, sources[i]);
+  }
+  int batch = 64 * MS_BFS_WORDS;
+  for (int i = 0; i < source_size; i += batch) {
+    int size = source_size - i < batch ? source_size - i : batch;
+    ms_bfs_batch(csr, slots + i, size, matrix->hops + (size_t) i * n);
+  }
+  free(slots);
+  free_csr(csr);
+  return matrix;
+}
+
+void free_hop_matrix(HopMatrix *matrix) {
+  if (matrix) {
+    free(matrix->id_list);
+    free(matrix->source_list);
+    free(matrix->hops);
+    free(matrix);
+  }
+}
+int graph_dfs_visit(Graph *graph, int s, GraphVisitor *visitor) {
+  if (!has_vertex(graph, s)) return GRAPH_ERROR;
+  DfsEngine *engine = create_dfs_engine(graph);
+  if (!engine) return GRAPH_ERROR;
+  DfsHandler handler = {.pre_visit=visitor_discover, .post_visit=visitor_finish, .edge=visitor_examine_edge,
+      .ctx=visitor};
+  int ret = dfs_engine_run(engine, s, &handler) ? VISIT_CONTINUE : VISIT_STOP;
+  free_dfs_engine(engine);
+  return ret;
+}
+
+int graph_bfs_visit(Graph *graph, int s, GraphVisitor *visitor) {
+  if (!has_vertex(graph, s)) return GRAPH_ERROR;
+  Hashset *visited = new_hash_set(int_hash, int_compare);
+  register_hashset_free_functions(visited, free);
+  // triples of <id,pid,expand>, the queue only grows as far as the search goes
+  IntArray queue = {NULL, 0, 0};
+  int head = 0;
+  int ret = VISIT_CONTINUE;
+  put_hash_set(visited, new_id(s));
+  int result = visitor->discover ? visitor->discover(visitor->ctx, s, s) : VISIT_CONTINUE;
+  if (result == VISIT_STOP) {
+    ret = VISIT_STOP;
+  } else {
+    int_array_push(&queue, s);
+    int_array_push(&queue, s);
+    int_array_push(&queue, result != VISIT_SKIP);
+  }
+  while (ret != VISIT_STOP && head < queue.size) {
+    int id = queue.data[head++];
+    int pid = queue.data[head++];
+    int expand = queue.data[head++];
+    Hashset *adj = get_adj_set(graph, id);
+    if (adj && expand) {
+      HashsetIterator *iter = hashset_iterator(adj);
+      while (hashset_iter_has_next(iter)) {
+        Edge *edge = set_entry_key(hashset_next_entry(iter));
+        result = visitor->examine_edge ? visitor->examine_edge(visitor->ctx, edge) : VISIT_CONTINUE;
+        if (result == VISIT_STOP) {
+          ret = VISIT_STOP;
+          break;
+        }
+        if (result == VISIT_SKIP || contains_in_hash_set(visited, &edge->to)) continue;
+        put_hash_set(visited, new_id(edge->to));
+        result = visitor->discover ? visitor->discover(visitor->ctx, edge->to, id) : VISIT_CONTINUE;
+        if (result == VISIT_STOP) {
+          ret = VISIT_STOP;
+          break;
+        }
+        int_array_push(&queue, edge->to);
+        int_array_push(&queue, id);
+        int_array_push(&queue, result != VISIT_SKIP);
+      }
+      free_hashset_iter(iter);
+      if (ret == VISIT_STOP) break;
+    }
+    if (visitor->finish && visitor->finish(visitor->ctx, id, pid) == VISIT_STOP) {
+      ret = VISIT_STOP;
+      break;
+    }
+  }
+  free(queue.data);
+  free_hash_set(visited);
+  return ret;
+}
+
+void free_vertex_label(VertexLabel *vertex_label) {
+  if (vertex_label) {
+    free(vertex_label->id_list);
+    free(vertex_label->label);
+    free(vertex_label);
+  }
+}
+
+SearchWorkspace *create_search_workspace(void) {
+  SearchWorkspace *workspace = calloc(1, sizeof(SearchWorkspace));
+  if (!workspace) return NULL;
+  workspace->index = new_hash_table(int_hash, int_compare);
+  // key is inside the slot
+  register_hashtable_free_functions(workspace->index, NULL, free);
+  return workspace;
+}
+
+void free_search_workspace(SearchWorkspace *workspace) {
+  if (workspace) {
+    free_hash_table(workspace->index);
+    free(workspace->ids);
+    free(workspace->label);
+    free(workspace->settled);
+    free(workspace->queue.data);
+    free(workspace->heap);
+    free(workspace);
+  }
+}
+
+VertexLabel *k_hop_neighborhood(Graph *graph, int s, int k, SearchWorkspace *workspace) {
+  if (!has_vertex(graph, s) || k < 0) return NULL;
+  SearchWorkspace *ws = workspace ? workspace : create_search_workspace();
+  reset_search_workspace(ws);
+  int fresh;
+  int idx = search_slot(ws, s, &fresh);
+  ws->label[idx] = 0;
+  int_array_push(&ws->queue, idx);
+  int head = 0;
+  while (head < ws->queue.size) {
+    int cur = ws->queue.data[head++];
+    int hops = ws->label[cur];
+    if (hops == k) continue;
+    Hashset *adj = get_adj_set(graph, ws->ids[cur]);
+    if (!adj) continue;
+    HashsetIterator *iter = hashset_iterator(adj);
+    while (hashset_iter_has_next(iter)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iter));
+      int w = search_slot(ws, edge->to, &fresh);
+      if (fresh) {
+        ws->label[w] = hops + 1;
+        int_array_push(&ws->queue, w);
+      }
+    }
+    free_hashset_iter(iter);
+  }
+  VertexLabel *result = search_result(ws, ws->queue.data, ws->queue.size);
+  if (!workspace) free_search_workspace(ws);
+  return result;
+}
+
+VertexLabel *dijkstra_within(Graph *graph, int s, int radius, SearchWorkspace *workspace) {
+  assert(graph->weighted);
+  if (!has_vertex(graph, s) || radius < 0) return NULL;
+  SearchWorkspace *ws = workspace ? workspace : create_search_workspace();
+  reset_search_workspace(ws);
+  int fresh;
+  int idx = search_slot(ws, s, &fresh);
+  ws->label[idx] = 0;
+  search_heap_push(ws, 0, idx);
+  // settled vertexes in order
+  IntArray order = {NULL, 0, 0};
+  while (ws->heap_size > 0) {
+    SearchHeapNode node = search_heap_pop(ws);
+    int cur = node.idx;
+    if (ws->settled[cur] || node.dis > ws->label[cur]) continue;
+    ws->settled[cur] = 1;
+    int_array_push(&order, cur);
+    Hashset *adj = get_adj_set(graph, ws->ids[cur]);
+    if (!adj) continue;
+    HashsetIterator *iter = hashset_iterator(adj);
+    while (hashset_iter_has_next(iter)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iter));
+      if (edge->weight < 0) {
+        // the cut-off at radius needs distances that never decrease along a path
+        free_hashset_iter(iter);
+        free(order.data);
+        if (!workspace) free_search_workspace(ws);
+        return NULL;
+      }
+      int dis = node.dis + edge->weight;
+      // vertexes beyond radius are never touched
+      if (dis > radius) continue;
+      int w = search_slot(ws, edge->to, &fresh);
+      if (fresh || (!ws->settled[w] && dis < ws->label[w])) {
+        ws->label[w] = dis;
+        search_heap_push(ws, dis, w);
+      }
+    }
+    free_hashset_iter(iter);
+  }
+  VertexLabel *result = search_result(ws, order.data, order.size);
+  free(order.data);
+  if (!workspace) free_search_workspace(ws);
+  return result;
+}
+VertexLabel *scc_pearce(Graph *graph) {
+  CSR *index = create_csr_index(graph);
+  if (!index) return NULL;
+  int n = index->n;
+  // rindex is 0 for unvisited vertexes, the dfs index while on the stack, and c (counting down from n - 1)
+  // once the component is done
+  int *rindex = calloc(n + 1, sizeof(int));
+  int *frame_v = malloc(sizeof(int) * (n + 1));
+  HashsetIterator **frame_iter = malloc(sizeof(HashsetIterator *) * (n + 1));
+  char *frame_root = malloc(n + 1);
+  int *stack = malloc(sizeof(int) * (n + 1));
+  int top = 0;
+  int next_index = 1;
+  int c = n - 1;
+  for (int v = 0; v < n; ++v) {
+    if (rindex[v] == 0) {
+      scc_pearce_visit(graph, index, v, rindex, frame_v, frame_iter, frame_root, stack, &top, &next_index, &c);
+    }
+  }
+  VertexLabel *result = new_vertex_label(n);
+  if (result) {
+    for (int v = 0; v < n; ++v) {
+      result->id_list[v] = index->ids[v];
+      result->label[v] = n - 1 - rindex[v];
+    }
+  }
+  free(rindex);
+  free(frame_v);
+  free(frame_iter);
+  free(frame_root);
+  free(stack);
+  free_csr(index);
+  return result;
+}
+typedef struct ParScc {
+  CSR *csr;
+  atomic_int *comp;     // -1 while the component of the vertex is not found
+  atomic_int next_comp;
+  atomic_int *in_deg;   // in and out degree among vertexes not trimmed yet
+  atomic_int *out_deg;
+  atomic_int *mark;     // visited marks of par_scc_reach
+  int out;              // par_scc_reach follows out edges if 1, in edges if 0
+  atomic_int *color;
+  atomic_int changed;
+  int *frontier;
+  int frontier_size;
+  atomic_int cursor;
+  IntArray *local;
+} ParScc;
+
+/**
+ * run a frontier task of ParScc until the frontier is empty, merging the local frontiers after each level
+ */
+static void par_scc_run_frontier(ParScc *scc, int threads, ParallelTask task) {
+  while (scc->frontier_size > 0) {
+    atomic_store(&scc->cursor, 0);
+    int level_threads = scc->frontier_size < PAR_GRAIN ? 1 : threads;
+    parallel_run(level_threads, task, scc);
+    int size = 0;
+    for (int t = 0; t < level_threads; ++t) {
+      if (scc->local[t].size == 0) continue;
+      memcpy(scc->frontier + size, scc->local[t].data, sizeof(int) * scc->local[t].size);
+      size += scc->local[t].size;
+    }
+    scc->frontier_size = size;
+  }
+}
+
+VertexLabel *scc_par(Graph *graph, int threads) {
+  threads = resolve_threads(threads);
+  CSR *csr = create_csr(graph);
+  if (!csr) return NULL;
+  csr_build_in(csr);
+  int n = csr->n;
+  ParScc scc = {.csr=csr};
+  scc.comp = malloc(sizeof(atomic_int) * (n + 1));
+  scc.in_deg = malloc(sizeof(atomic_int) * (n + 1));
+  scc.out_deg = malloc(sizeof(atomic_int) * (n + 1));
+  scc.color = malloc(sizeof(atomic_int) * (n + 1));
+  atomic_int *fw = malloc(sizeof(atomic_int) * (n + 1));
+  atomic_int *bw = malloc(sizeof(atomic_int) * (n + 1));
+  // a vertex can be put to the frontier once for each of in and out degree
+  scc.frontier = malloc(sizeof(int) * (2 * n + 1));
+  scc.local = calloc(threads, sizeof(IntArray));
+  atomic_init(&scc.next_comp, 0);
+  scc.frontier_size = 0;
+  for (int v = 0; v < n; ++v) {
+    atomic_init(&scc.comp[v], -1);
+    atomic_init(&scc.in_deg[v], csr->in_offset[v + 1] - csr->in_offset[v]);
+    atomic_init(&scc.out_deg[v], csr->offset[v + 1] - csr->offset[v]);
+    atomic_init(&fw[v], 0);
+    atomic_init(&bw[v], 0);
+    if (csr->in_offset[v + 1] == csr->in_offset[v] || csr->offset[v + 1] == csr->offset[v]) {
+      scc.frontier[scc.frontier_size++] = v;
+    }
+  }
+
+  // trim
+  par_scc_run_frontier(&scc, threads, par_scc_trim);
+
+  // forward-backward from the pivot, which is likely in the giant component
+  int pivot = -1;
+  long long best = -1;
+  for (int v = 0; v < n; ++v) {
+    if (atomic_load(&scc.comp[v]) >= 0) continue;
+    long long d = (long long) atomic_load(&scc.in_deg[v]) * atomic_load(&scc.out_deg[v]);
+    if (d > best) {
+      best = d;
+      pivot = v;
+    }
+  }
+  if (pivot >= 0) {
+    for (int dir = 0; dir <= 1; ++dir) {
+      scc.mark = dir ? bw : fw;
+      scc.out = !dir;
+      atomic_store(&scc.mark[pivot], 1);
+      scc.frontier[0] = pivot;
+      scc.frontier_size = 1;
+      par_scc_run_frontier(&scc, threads, par_scc_reach);
+    }
+    int cid = atomic_fetch_add(&scc.next_comp, 1);
+    for (int v = 0; v < n; ++v) {
+      if (atomic_load(&fw[v]) && atomic_load(&bw[v])) {
+        atomic_store(&scc.comp[v], cid);
+      }
+    }
+  }
+
+  // coloring for the rest
+  while (1) {
+    atomic_store(&scc.changed, 0);
+    parallel_run(threads, par_scc_color_init, &scc);
+    if (!atomic_load(&scc.changed)) break;
+    do {
+      atomic_store(&scc.changed, 0);
+      parallel_run(threads, par_scc_color_propagate, &scc);
+    } while (atomic_load(&scc.changed));
+    atomic_store(&scc.cursor, 0);
+    parallel_run(threads, par_scc_color_collect, &scc);
+  }
+
+  VertexLabel *result = new_vertex_label(n);
+  if (result) {
+    for (int v = 0; v < n; ++v) {
+      result->id_list[v] = csr->ids[v];
+      result->label[v] = atomic_load(&scc.comp[v]);
+    }
+  }
+  for (int t = 0; t < threads; ++t) {
+    free(scc.local[t].data);
+  }
+  free(scc.local);
+  free(scc.frontier);
+  free(fw);
+  free(bw);
+  free(scc.color);
+  free(scc.out_deg);
+  free(scc.in_deg);
+  free(scc.comp);
+  free_csr(csr);
+  return result;
+}
+IdUnionFind *create_id_uf(void) {
+  IdUnionFind *uf = calloc(1, sizeof(IdUnionFind));
+  if (!uf) return NULL;
+  uf->index = new_hash_table(int_hash, int_compare);
+  // key is inside the slot
+  register_hashtable_free_functions(uf->index, NULL, free);
+  return uf;
+}
+
+int id_uf_add(IdUnionFind *uf, int id) {
+  int size = uf->uf.size;
+  id_uf_slot(uf, id, 1);
+  return uf->uf.size > size;
+}
+
+int id_uf_union(IdUnionFind *uf, int id1, int id2) {
+  int x = id_uf_slot(uf, id1, 1);
+  int y = id_uf_slot(uf, id2, 1);
+  return dense_uf_union(&uf->uf, x, y);
+}
+
+int id_uf_find(IdUnionFind *uf, int id) {
+  int x = id_uf_slot(uf, id, 0);
+  if (x < 0) return id;
+  return uf->ids[dense_uf_find(&uf->uf, x)];
+}
+
+int id_uf_same_set(IdUnionFind *uf, int id1, int id2) {
+  return id1 == id2 || id_uf_find(uf, id1) == id_uf_find(uf, id2);
+}
+
+int id_uf_count(IdUnionFind *uf) {
+  return uf->uf.count;
+}
+
+void free_id_uf(IdUnionFind *uf) {
+  if (uf) {
+    free_hash_table(uf->index);
+    free(uf->ids);
+    dense_uf_free(&uf->uf);
+    free(uf);
+  }
+}
+
+VertexLabel *graph_components_uf(Graph *graph) {
+  CSR *index = create_csr_index(graph);
+  if (!index) return NULL;
+  int n = index->n;
+  DenseUF uf = {NULL, NULL, 0, 0, 0};
+  uf_over_edges(graph, index, &uf);
+
+  VertexLabel *result = new_vertex_label(n);
+  if (result) {
+    // number roots in order of first appearance
+    int *root_label = malloc(sizeof(int) * (n + 1));
+    for (int v = 0; v < n; ++v) {
+      root_label[v] = -1;
+    }
+    int c = 0;
+    for (int v = 0; v < n; ++v) {
+      int r = dense_uf_find(&uf, v);
+      if (root_label[r] < 0) root_label[r] = c++;
+      result->id_list[v] = index->ids[v];
+      result->label[v] = root_label[r];
+    }
+    free(root_label);
+  }
+  dense_uf_free(&uf);
+  free_csr(index);
+  return result;
+}
+typedef struct Afforest {
+  CSR *csr;
+  atomic_int *comp;
+  atomic_int cursor;
+  int round;
+  int skip;  // component that is not hooked any more
+} Afforest;
+
+VertexLabel *graph_components_par(Graph *graph, int threads) {
+  threads = resolve_threads(threads);
+  CSR *csr = create_csr(graph);
+  if (!csr) return NULL;
+  // hooking must see edges from both ends
+  csr_build_in(csr);
+  int n = csr->n;
+  Afforest af = {.csr=csr, .skip=-1};
+  af.comp = malloc(sizeof(atomic_int) * (n + 1));
+  for (int v = 0; v < n; ++v) {
+    atomic_init(&af.comp[v], v);
+  }
+  int job_threads = n < PAR_GRAIN ? 1 : threads;
+  for (af.round = 0; af.round < AFFOREST_ROUNDS; ++af.round) {
+    atomic_store(&af.cursor, 0);
+    parallel_run(job_threads, afforest_neighbor_round, &af);
+    atomic_store(&af.cursor, 0);
+    parallel_run(job_threads, afforest_compress, &af);
+  }
+
+  // most frequent component in a sample
+  if (n > 0) {
+    int *sample = malloc(sizeof(int) * AFFOREST_SAMPLES);
+    unsigned int seed = 2166136261u;
+    for (int i = 0; i < AFFOREST_SAMPLES; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      sample[i] = atomic_load(&af.comp[(seed >> 8) % n]);
+    }
+    qsort(sample, AFFOREST_SAMPLES, sizeof(int), int_qsort_compare);
+    int best = 0;
+    for (int i = 0, j; i < AFFOREST_SAMPLES; i = j) {
+      for (j = i; j < AFFOREST_SAMPLES && sample[j] == sample[i]; ++j);
+      if (j - i > best) {
+        best = j - i;
+        af.skip = sample[i];
+      }
+    }
+    free(sample);
+  }
+
+  atomic_store(&af.cursor, 0);
+  parallel_run(job_threads, afforest_finish, &af);
+  atomic_store(&af.cursor, 0);
+  parallel_run(job_threads, afforest_compress, &af);
+
+  VertexLabel *result = new_vertex_label(n);
+  if (result) {
+    int *root_label = malloc(sizeof(int) * (n + 1));
+    for (int v = 0; v < n; ++v) {
+      root_label[v] = -1;
+    }
+    int c = 0;
+    for (int v = 0; v < n; ++v) {
+      int r = atomic_load(&af.comp[v]);
+      if (root_label[r] < 0) root_label[r] = c++;
+      result->id_list[v] = csr->ids[v];
+      result->label[v] = root_label[r];
+    }
+    free(root_label);
+  }
+  free(af.comp);
+  free_csr(csr);
+  return result;
+}
+int enable_connectivity_index(Graph *graph) {
+  if (graph->directed) return GRAPH_ERROR;
+  if (!graph->connectivity) {
+    graph->connectivity = create_id_uf();
+    if (!graph->connectivity) return GRAPH_ERROR;
+    graph->connectivity_stale = 1;
+    fresh_connectivity(graph);
+  }
+  return GRAPH_SUCCESS;
+}
+
+void disable_connectivity_index(Graph *graph) {
+  free_id_uf(graph->connectivity);
+  graph->connectivity = NULL;
+  graph->connectivity_stale = 0;
+}
+int enable_dynamic_connectivity(Graph *graph) {
+  if (graph->directed) return GRAPH_ERROR;
+  if (graph->dynamic) return GRAPH_SUCCESS;
+  DynamicConnectivity *dc = calloc(1, sizeof(DynamicConnectivity));
+  if (!dc) return GRAPH_ERROR;
+  dc->index = new_hash_table(int_hash, int_compare);
+  // key is inside the slot
+  register_hashtable_free_functions(dc->index, NULL, free);
+  dc->tree = new_hash_table(default_edge_hash_func, default_edge_equal_func);
+  // key is inside the arc
+  register_hashtable_free_functions(dc->tree, NULL, free);
+  dc->seed = 2463534242u;
+  HashtableIterator *iter = hashtable_iterator(graph->represent);
+  while (hashtable_iter_has_next(iter)) {
+    dyn_add_vertex(dc, *(int *) table_entry_key(hashtable_next_entry(iter)));
+  }
+  free_hashtable_iter(iter);
+  iter = hashtable_iterator(graph->edges);
+  while (hashtable_iter_has_next(iter)) {
+    HashsetIterator *iterator = hashset_iterator(table_entry_value(hashtable_next_entry(iter)));
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      // every undirected edge is stored in both directions
+      if (edge->from < edge->to) {
+        dyn_insert_edge(dc, edge->from, edge->to);
+      }
+    }
+    free_hashset_iter(iterator);
+  }
+  free_hashtable_iter(iter);
+  graph->dynamic = dc;
+  return GRAPH_SUCCESS;
+}
+
+void disable_dynamic_connectivity(Graph *graph) {
+  free_dynamic_connectivity(graph->dynamic);
+  graph->dynamic = NULL;
+}
+Biconnectivity *biconnectivity(Graph *graph) {
+  if (graph->directed) return NULL;
+  CSR *csr = create_csr(graph);
+  if (!csr) return NULL;
+  int n = csr->n;
+  int *ord = malloc(sizeof(int) * (n + 1));
+  int *low = malloc(sizeof(int) * (n + 1));
+  int *parent = malloc(sizeof(int) * (n + 1));
+  int *next_arc = malloc(sizeof(int) * (n + 1)); // next out arc to examine of vertexes on the dfs stack
+  int *stack = malloc(sizeof(int) * (n + 1));
+  int *stamp = malloc(sizeof(int) * (n + 1));    // last block a vertex was added to
+  char *is_cut = calloc(n + 1, 1);
+  for (int v = 0; v < n; ++v) {
+    ord[v] = -1;
+    stamp[v] = -1;
+  }
+  IntArray edge_stack = {NULL, 0, 0}; // tree and back edges of the open blocks, two slots per edge
+  IntArray bridges = {NULL, 0, 0};
+  IntArray block_offset = {NULL, 0, 0};
+  IntArray block_vertex = {NULL, 0, 0};
+  int_array_push(&block_offset, 0);
+  int visited_count = 0;
+
+  for (int r = 0; r < n; ++r) {
+    if (ord[r] >= 0) continue;
+    ord[r] = low[r] = visited_count++;
+    if (csr->offset[r] == csr->offset[r + 1]) {
+      int_array_push(&block_vertex, csr->ids[r]);
+      int_array_push(&block_offset, block_vertex.size);
+      continue;
+    }
+    parent[r] = -1;
+    next_arc[r] = csr->offset[r];
+    int top = 0;
+    int root_children = 0;
+    stack[top++] = r;
+    while (top > 0) {
+      int v = stack[top - 1];
+      if (next_arc[v] < csr->offset[v + 1]) {
+        int w = csr->adj[next_arc[v]++];
+        if (ord[w] < 0) {
+          // tree edge
+          ord[w] = low[w] = visited_count++;
+          parent[w] = v;
+          next_arc[w] = csr->offset[w];
+          int_array_push(&edge_stack, v);
+          int_array_push(&edge_stack, w);
+          stack[top++] = w;
+          if (v == r) root_children++;
+        } else if (w != parent[v] && ord[w] < ord[v]) {
+          // back edge, each one is seen from its lower end only
+          int_array_push(&edge_stack, v);
+          int_array_push(&edge_stack, w);
+          if (low[v] > ord[w]) low[v] = ord[w];
+        }
+        continue;
+      }
+      top--;
+      int p = parent[v];
+      if (p < 0) continue;
+      if (low[p] > low[v]) low[p] = low[v];
+      if (low[v] > ord[p]) {
+        int_array_push(&bridges, csr->ids[p]);
+        int_array_push(&bridges, csr->ids[v]);
+      }
+      if (low[v] >= ord[p]) {
+        // p separates the subtree of v, the edges above <p, v> on the stack form a block
+        if (p != r) is_cut[p] = 1;
+        int block = block_offset.size - 1;
+        int a, b;
+        do {
+          b = edge_stack.data[--edge_stack.size];
+          a = edge_stack.data[--edge_stack.size];
+          if (stamp[a] != block) {
+            stamp[a] = block;
+            int_array_push(&block_vertex, csr->ids[a]);
+          }
+          if (stamp[b] != block) {
+            stamp[b] = block;
+            int_array_push(&block_vertex, csr->ids[b]);
+          }
+        } while (a != p || b != v);
+        int_array_push(&block_offset, block_vertex.size);
+      }
+    }
+    if (root_children > 1) is_cut[r] = 1;
+  }
+
+  Biconnectivity *result = malloc(sizeof(Biconnectivity));
+  if (result) {
+    int cut_point_size = 0;
+    for (int v = 0; v < n; ++v) {
+      cut_point_size += is_cut[v];
+    }
+    result->cut_points = malloc(sizeof(int) * (cut_point_size + 1));
+    result->cut_point_size = 0;
+    for (int v = 0; v < n; ++v) {
+      if (is_cut[v]) result->cut_points[result->cut_point_size++] = csr->ids[v];
+    }
+    result->bridges = bridges.data;
+    result->bridge_size = bridges.size / 2;
+    result->block_offset = block_offset.data;
+    result->block_vertex = block_vertex.data;
+    result->block_size = block_offset.size - 1;
+  } else {
+    free(bridges.data);
+    free(block_offset.data);
+    free(block_vertex.data);
+  }
+  free(edge_stack.data);
+  free(ord);
+  free(low);
+  free(parent);
+  free(next_arc);
+  free(stack);
+  free(stamp);
+  free(is_cut);
+  free_csr(csr);
+  return result;
+}
+
+void free_biconnectivity(Biconnectivity *biconnectivity) {
+  if (biconnectivity) {
+    free(biconnectivity->bridges);
+    free(biconnectivity->cut_points);
+    free(biconnectivity->block_offset);
+    free(biconnectivity->block_vertex);
+    free(biconnectivity);
+  }
+}
+
+CutIndex *create_cut_index(Graph *graph) {
+  if (graph->directed) return NULL;
+  CutIndex *ci = calloc(1, sizeof(CutIndex));
+  if (!ci) return NULL;
+  ci->index = create_csr_index(graph);
+  Biconnectivity *bc = biconnectivity(graph);
+  int n = ci->index->n;
+  int blocks = bc->block_size;
+
+  // block-cut forest: nodes [0, blocks) are blocks, cut points follow, a cut point is joined to its blocks
+  ci->is_cut = calloc(n + 1, 1);
+  ci->block_node = malloc(sizeof(int) * (n + 1));
+  for (int i = 0; i < bc->cut_point_size; ++i) {
+    int s = csr_slot(ci->index, bc->cut_points[i]);
+    ci->is_cut[s] = 1;
+    ci->block_node[s] = blocks + i;
+  }
+  IntArray edges = {NULL, 0, 0};
+  for (int i = 0; i < blocks; ++i) {
+    for (int j = bc->block_offset[i]; j < bc->block_offset[i + 1]; ++j) {
+      int s = csr_slot(ci->index, bc->block_vertex[j]);
+      if (ci->is_cut[s]) {
+        int_array_push(&edges, i);
+        int_array_push(&edges, ci->block_node[s]);
+      } else {
+        ci->block_node[s] = i;
+      }
+    }
+  }
+  ci->block_cut = create_lca_forest(blocks + bc->cut_point_size, edges.data, edges.size / 2);
+
+  // bridge tree: a block of more than two vertexes is not a bridge, its vertexes are 2-edge-connected
+  DenseUF uf = {NULL, NULL, 0, 0, 0};
+  for (int v = 0; v < n; ++v) {
+    dense_uf_add(&uf);
+  }
+  for (int i = 0; i < blocks; ++i) {
+    int first = bc->block_offset[i];
+    if (bc->block_offset[i + 1] - first <= 2) continue;
+    int s = csr_slot(ci->index, bc->block_vertex[first]);
+    for (int j = first + 1; j < bc->block_offset[i + 1]; ++j) {
+      dense_uf_union(&uf, s, csr_slot(ci->index, bc->block_vertex[j]));
+    }
+  }
+  ci->two_edge = malloc(sizeof(int) * (n + 1));
+  int *label = malloc(sizeof(int) * (n + 1));
+  int components = 0;
+  for (int v = 0; v < n; ++v) {
+    label[v] = -1;
+  }
+  for (int v = 0; v < n; ++v) {
+    int r = dense_uf_find(&uf, v);
+    if (label[r] < 0) label[r] = components++;
+    ci->two_edge[v] = label[r];
+  }
+  edges.size = 0;
+  for (int i = 0; i < bc->bridge_size; ++i) {
+    int_array_push(&edges, ci->two_edge[csr_slot(ci->index, bc->bridges[2 * i])]);
+    int_array_push(&edges, ci->two_edge[csr_slot(ci->index, bc->bridges[2 * i + 1])]);
+  }
+  ci->bridge_tree = create_lca_forest(components, edges.data, edges.size / 2);
+  ci->bridge_end = malloc(sizeof(int) * (2 * components + 1));
+  for (int i = 0; i < bc->bridge_size; ++i) {
+    int s1 = csr_slot(ci->index, bc->bridges[2 * i]);
+    int s2 = csr_slot(ci->index, bc->bridges[2 * i + 1]);
+    int child = ci->bridge_tree->up[ci->two_edge[s1]] == ci->two_edge[s2] ? ci->two_edge[s1] : ci->two_edge[s2];
+    ci->bridge_end[2 * child] = s1;
+    ci->bridge_end[2 * child + 1] = s2;
+  }
+
+  free(label);
+  free(edges.data);
+  dense_uf_free(&uf);
+  free_biconnectivity(bc);
+  return ci;
+}
+
+int cut_vertex_separates(CutIndex *index, int x, int a, int b) {
+  int sx = csr_slot(index->index, x);
+  int sa = csr_slot(index->index, a);
+  int sb = csr_slot(index->index, b);
+  if (sx < 0 || sa < 0 || sb < 0 || sa == sb || sx == sa || sx == sb) return 0;
+  // only a cut point can separate, and it does iff its cut node is on the tree path
+  if (!index->is_cut[sx]) return 0;
+  LcaForest *forest = index->block_cut;
+  int na = index->block_node[sa];
+  int nb = index->block_node[sb];
+  int nx = index->block_node[sx];
+  if (forest->root[na] != forest->root[nb]) return 0;
+  int l = lca_forest_lca(forest, na, nb);
+  return lca_is_ancestor(forest, l, nx) && (lca_is_ancestor(forest, nx, na) || lca_is_ancestor(forest, nx, nb));
+}
+
+int cut_edge_separates(CutIndex *index, int u, int v, int a, int b) {
+  int su = csr_slot(index->index, u);
+  int sv = csr_slot(index->index, v);
+  int sa = csr_slot(index->index, a);
+  int sb = csr_slot(index->index, b);
+  if (su < 0 || sv < 0 || sa < 0 || sb < 0) return 0;
+  LcaForest *forest = index->bridge_tree;
+  int cu = index->two_edge[su];
+  int cv = index->two_edge[sv];
+  if (cu == cv) return 0;
+  int child = forest->depth[cu] > forest->depth[cv] ? cu : cv;
+  int parent = child == cu ? cv : cu;
+  if (forest->up[child] != parent) return 0;
+  // the components may be joined by a bridge between other vertexes
+  int e1 = index->bridge_end[2 * child];
+  int e2 = index->bridge_end[2 * child + 1];
+  if (!((e1 == su && e2 == sv) || (e1 == sv && e2 == su))) return 0;
+  int ca = index->two_edge[sa];
+  int cb = index->two_edge[sb];
+  if (forest->root[ca] != forest->root[cb]) return 0;
+  return lca_is_ancestor(forest, child, ca) != lca_is_ancestor(forest, child, cb);
+}
+
+void free_cut_index(CutIndex *index) {
+  if (index) {
+    free_csr(index->index);
+    free(index->is_cut);
+    free(index->block_node);
+    free_lca_forest(index->block_cut);
+    free(index->two_edge);
+    free(index->bridge_end);
+    free_lca_forest(index->bridge_tree);
+    free(index);
+  }
+}
+
+VertexLabel *dominator_tree(Graph *graph, int root) {
+  if (!has_vertex(graph, root)) return NULL;
+  CSR *csr = create_csr(graph);
+  csr_build_in(csr);
+  int n = csr->n;
+  int *idom = malloc(sizeof(int) * (n + 1));
+  dominators(n, csr->offset, csr->adj, csr->in_offset, csr->in_adj, csr_slot(csr, root), idom);
+  int size = 0;
+  for (int v = 0; v < n; ++v) {
+    if (idom[v] >= 0) size++;
+  }
+  VertexLabel *result = new_vertex_label(size);
+  if (result) {
+    size = 0;
+    for (int v = 0; v < n; ++v) {
+      if (idom[v] < 0) continue;
+      result->id_list[size] = csr->ids[v];
+      result->label[size] = csr->ids[idom[v]];
+      size++;
+    }
+  }
+  free(idom);
+  free_csr(csr);
+  return result;
+}
+
+int enable_incremental_msf(Graph *graph) {
+  if (graph->directed || !graph->weighted) return GRAPH_ERROR;
+  if (graph->msf) return GRAPH_SUCCESS;
+  graph->msf = create_incremental_msf(graph);
+  return graph->msf ? GRAPH_SUCCESS : GRAPH_ERROR;
+}
+
+void disable_incremental_msf(Graph *graph) {
+  free_incremental_msf(graph->msf);
+  graph->msf = NULL;
+}
+
+long incremental_msf_weight(Graph *graph) {
+  assert(graph->msf);
+  return fresh_msf(graph)->weight;
+}
+
+int incremental_msf(Graph *graph, SpanningEdgeHandler handler, void *ctx) {
+  assert(graph->msf);
+  IncrementalMsf *msf = fresh_msf(graph);
+  for (int x = 0; x < msf->size; ++x) {
+    LctNode *node = &msf->nodes[x];
+    if (node->from >= 0) {
+      handler(ctx, msf->ids[node->from], msf->ids[node->to], node->weight);
+    }
+  }
+  return msf->vertex_count - msf->tree_edges;
+}
+
+//---------------Graph Algorithms-----------------
+
+//--------------- static functions ----------------------
+static int bfs_hungarian(Graph *graph, Hashtable *matching, int id) {
+  Hashtable *pre = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(pre, free, free);
+  Dqueue *queue = new_dqueue();
+
+  put_hash_table(pre, new_id(id), new_id(id));
+  dqueue_push_tail(queue, &id);
+  while (!dqueue_is_empty(queue)) {
+    int *cur = dqueue_pop_head(queue);
+    Hashset *adj = get_adj_set(graph, *cur);
+    HashsetIterator *iter = hashset_iterator(adj);
+    while (hashset_iter_has_next(iter)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iter));
+      int next = get_edge_to(edge);
+      if (!contains_in_hash_table(pre, &next)) {
+        // find a matched vertex on right side
+        if (contains_in_hash_table(matching, &next)) {
+          put_hash_table(pre, new_id(next), new_id(*cur));
+          int *match = get_hash_table(matching, &next);
+          put_hash_table(pre, new_id(*match), new_id(next));
+          dqueue_push_tail(queue, match);
+        } else {
+          // find the end of augmenting path
           put_hash_table(pre, new_id(next), new_id(*cur));
           LinkedList *path = track_path(pre, next, id);
           int i = 0;
@@ -1895,182 +3757,84 @@ static int dfs_hamilton_loop_path(Graph *graph, Hashtable *visited, int start, i
   return 0;
 }
 
-static void find_cut_point_ud(Graph *graph,
-                              Hashset *visited,
-                              Hashtable *ord,
-                              Hashtable *low,
-                              int visited_count,
-                              int id,
-                              int pid,
-                              LinkedList *result) {
+static void bfs(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry) {
   put_hash_set(visited, new_id(id));
-  put_hash_table(ord, new_id(id), new_id(visited_count));
-  put_hash_table(low, new_id(id), new_id(visited_count));
-  visited_count++;
-
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    int child = 0;
-
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      int is_visited = contains_in_hash_set(visited, &edge->to);
-      if (!is_visited) {
-        find_cut_point_ud(graph, visited, ord, low, visited_count, edge->to, id, result);
-        int *low_v = get_hash_table(low, &id);
-        int *low_t = get_hash_table(low, &edge->to);
-        if (*low_v > *low_t) {
-          *low_v = *low_t;
-        }
-        // find a cut points
-        if (id != pid && *low_t >= *(int *) get_hash_table(ord, &id)) {
-          append_list(result, new_id(id));
-        }
-        child++;
-        if (id == pid && child > 1) {
-          append_list(result, new_id(id));
-        }
-      } else if (edge->to != pid) {
-        // this is a circle, must not be a bridge
-        int *low_v = get_hash_table(low, &id);
-        int *low_t = get_hash_table(low, &edge->to);
-        if (*low_v > *low_t) {
-          *low_v = *low_t;
+  Dqueue *dqueue = new_dqueue();
+  dqueue_push_tail(dqueue, new_id(id));
+  while (!dqueue_is_empty(dqueue)) {
+    int *v = dqueue_pop_head(dqueue);
+    int vid = *v;
+    vertex_entry->id_list[vertex_entry->size++] = *v;
+    free(v);
+    Hashset *adj = get_adj_set(graph, vid);
+    if (adj) {
+      HashsetIterator *iterator = hashset_iterator(adj);
+      while (hashset_iter_has_next(iterator)) {
+        Edge *edge = set_entry_key(hashset_next_entry(iterator));
+        int is_visited = contains_in_hash_set(visited, &edge->to);
+        if (!is_visited) {
+          dqueue_push_tail(dqueue, new_id(edge->to));
+          put_hash_set(visited, new_id(edge->to));
         }
       }
+      free_hashset_iter(iterator);
     }
-    free_hashset_iter(iterator);
   }
-}
-
-/**
- * find bridge for undirected graph
- *
- * @param graph
- * @param visited
- * @param ord
- * @param low
- * @param visited_count
- * @param id
- * @param pid
- */
-static void find_bridge_ud(Graph *graph,
-                           Hashset *visited,
-                           Hashtable *ord,
-                           Hashtable *low,
-                           int visited_count,
-                           int id,
-                           int pid,
-                           LinkedList *result) {
-  put_hash_set(visited, new_id(id));
-  put_hash_table(ord, new_id(id), new_id(visited_count));
-  put_hash_table(low, new_id(id), new_id(visited_count));
-  visited_count++;
-
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      int is_visited = contains_in_hash_set(visited, &edge->to);
-      if (!is_visited) {
-        find_bridge_ud(graph, visited, ord, low, visited_count, edge->to, id, result);
-        int *low_v = get_hash_table(low, &id);
-        int *low_t = get_hash_table(low, &edge->to);
-        if (*low_v > *low_t) {
-          *low_v = *low_t;
-        }
-        // find a bridge
-        if (*low_t > *(int *) get_hash_table(ord, &id)) {
-          append_list(result, edge);
-        }
-      } else if (edge->to != pid) {
-        // this is a circle, must not be a bridge
-        int *low_v = get_hash_table(low, &id);
-        int *low_t = get_hash_table(low, &edge->to);
-        if (*low_v > *low_t) {
-          *low_v = *low_t;
-        }
-      }
-    }
-    free_hashset_iter(iterator);
-  }
-}
-
-static void bfs(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry) {
-  put_hash_set(visited, new_id(id));
-  Dqueue *dqueue = new_dqueue();
-  dqueue_push_tail(dqueue, new_id(id));
-  while (!dqueue_is_empty(dqueue)) {
-    int *v = dqueue_pop_head(dqueue);
-    int vid = *v;
-    vertex_entry->id_list[vertex_entry->size++] = *v;
-    free(v);
-    Hashset *adj = get_adj_set(graph, vid);
-    if (adj) {
-      HashsetIterator *iterator = hashset_iterator(adj);
-      while (hashset_iter_has_next(iterator)) {
-        Edge *edge = set_entry_key(hashset_next_entry(iterator));
-        int is_visited = contains_in_hash_set(visited, &edge->to);
-        if (!is_visited) {
-          dqueue_push_tail(dqueue, new_id(edge->to));
-          put_hash_set(visited, new_id(edge->to));
-        }
-      }
-      free_hashset_iter(iterator);
-    }
-  }
-  free_dqueue(dqueue);
+  free_dqueue(dqueue);
 }
 
 static int bfs_cmp(Graph *graph, Hashtable *visited, int id, int pid, int target) {
   // TODO
 }
 
-static int dfs_bipartite_test(Graph *graph, Hashtable *visited, int id, int color) {
-  put_hash_table(visited, new_id(id), new_id(color));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      int is_visited = contains_in_hash_table(visited, &edge->to);
-      if (!is_visited) {
-        if (!dfs_bipartite_test(graph, visited, edge->to, 1 - color)) {
-          free_hashset_iter(iterator);
-          return 0;
-        }
-      } else if (*(int *) get_hash_table(visited, &edge->to) == color) {
-        free_hashset_iter(iterator);
-        return 0;
-      }
-    }
-    free_hashset_iter(iterator);
-  }
+typedef struct BipartiteContext {
+  Hashtable *visited;
+  int color;
+} BipartiteContext;
+
+static int bipartite_pre_visit(void *ctx, int id, int pid) {
+  BipartiteContext *c = ctx;
+  int color = id == pid ? c->color : 1 - *(int *) get_hash_table(c->visited, &pid);
+  put_hash_table(c->visited, new_id(id), new_id(color));
   return 1;
+}
+
+static int bipartite_edge(void *ctx, Edge *edge, DfsEdgeType type, int pid) {
+  (void) pid;
+  BipartiteContext *c = ctx;
+  if (type == DFS_TREE_EDGE) return 1;
+  return *(int *) get_hash_table(c->visited, &edge->to) != *(int *) get_hash_table(c->visited, &edge->from);
+}
 
+/**
+ * color the component of id with 0,1 into visited.
+ *
+ * @return 0 if two adjacent vertexes have the same color
+ */
+static int dfs_bipartite_test(DfsEngine *engine, Hashtable *visited, int id, int color) {
+  BipartiteContext ctx = {.visited=visited, .color=color};
+  DfsHandler handler = {.pre_visit=bipartite_pre_visit, .edge=bipartite_edge, .ctx=&ctx};
+  return dfs_engine_run(engine, id, &handler);
 }
 
 static int has_circle_undirected_graph(Graph *graph) {
-  Hashtable *visited = new_hash_table(int_hash, int_compare);
-  register_hashtable_free_functions(visited, free, free);
+  DfsEngine *engine = create_dfs_engine(graph);
   HashtableIterator *iter = hashtable_iterator(graph->represent);
 
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
-    if (!contains_in_hash_table(visited, id)) {
-      int ret = dfs_circle_test_undirected(graph, visited, *id, *id);
+    if (!dfs_engine_visited(engine, *id)) {
+      int ret = dfs_circle_test_undirected(engine, *id);
       if (ret) {
         free_hashtable_iter(iter);
-        free_hash_table(visited);
+        free_dfs_engine(engine);
         return 1;
       }
     }
   }
 
   free_hashtable_iter(iter);
-  free_hash_table(visited);
+  free_dfs_engine(engine);
   return 0;
 }
 
@@ -2167,29 +3931,23 @@ static void ud_circle_path(Graph *graph,
 }
 
 static int has_circle_directed_graph(Graph *graph) {
-  Hashtable *visited = new_hash_table(int_hash, int_compare);
-  register_hashtable_free_functions(visited, free, free);
-
-  Hashset *on_path = new_hash_set(int_hash, int_compare);
-  register_hashset_free_functions(on_path, free);
+  DfsEngine *engine = create_dfs_engine(graph);
   HashtableIterator *iter = hashtable_iterator(graph->represent);
 
   while (hashtable_iter_has_next(iter)) {
     int *id = table_entry_key(hashtable_next_entry(iter));
-    if (!contains_in_hash_table(visited, id)) {
-      int ret = dfs_circle_test_directed(graph, visited, on_path, *id, *id);
+    if (!dfs_engine_visited(engine, *id)) {
+      int ret = dfs_circle_test_directed(engine, *id);
       if (ret) {
         free_hashtable_iter(iter);
-        free_hash_table(visited);
-        free_hash_set(on_path);
+        free_dfs_engine(engine);
         return 1;
       }
     }
   }
 
   free_hashtable_iter(iter);
-  free_hash_table(visited);
-  free_hash_set(on_path);
+  free_dfs_engine(engine);
   return 0;
 }
 
@@ -2214,76 +3972,167 @@ static int *new_id(int value) {
   return id;
 }
 
+static DfsEngine *create_dfs_engine(Graph *graph) {
+  DfsEngine *engine = malloc(sizeof(DfsEngine));
+  if (!engine) return NULL;
+  engine->graph = graph;
+  engine->marks = new_hash_table(int_hash, int_compare);
+  // the key is the mark itself
+  register_hashtable_free_functions(engine->marks, free, NULL);
+  engine->order = 0;
+  engine->stack = NULL;
+  engine->stack_size = 0;
+  engine->stack_capacity = 0;
+  return engine;
+}
+
+static int dfs_engine_visited(DfsEngine *engine, int id) {
+  return contains_in_hash_table(engine->marks, &id);
+}
+
+static void free_dfs_engine(DfsEngine *engine) {
+  if (engine) {
+    for (int i = 0; i < engine->stack_size; ++i) {
+      if (engine->stack[i].iter) free_hashset_iter(engine->stack[i].iter);
+    }
+    free(engine->stack);
+    free_hash_table(engine->marks);
+    free(engine);
+  }
+}
+
+static int dfs_engine_discover(DfsEngine *engine, int id, int pid, DfsHandler *handler) {
+  DfsMark *mark = malloc(sizeof(DfsMark));
+  mark->id = id;
+  mark->ord = engine->order++;
+  mark->finished = 0;
+  put_hash_table(engine->marks, mark, mark);
+  if (engine->stack_size == engine->stack_capacity) {
+    engine->stack_capacity = engine->stack_capacity ? engine->stack_capacity * 2 : 64;
+    engine->stack = realloc(engine->stack, sizeof(DfsFrame) * engine->stack_capacity);
+  }
+  Hashset *adj = get_adj_set(engine->graph, id);
+  DfsFrame *frame = &engine->stack[engine->stack_size++];
+  frame->id = id;
+  frame->pid = pid;
+  frame->ord = mark->ord;
+  frame->iter = adj ? hashset_iterator(adj) : NULL;
+  int result = handler->pre_visit ? handler->pre_visit(handler->ctx, id, pid) : VISIT_CONTINUE;
+  if (result == VISIT_SKIP) {
+    if (frame->iter) free_hashset_iter(frame->iter);
+    frame->iter = NULL;
+  }
+  return result != VISIT_STOP;
+}
+
+/**
+ * dfs from root with an explicit stack, skipping vertexes visited by previous runs.
+ *
+ * @param engine
+ * @param root
+ * @param handler
+ * @return 1 if the traversal completed, 0 if it was stopped by a callback
+ */
+static int dfs_engine_run(DfsEngine *engine, int root, DfsHandler *handler) {
+  int ret = dfs_engine_discover(engine, root, root, handler);
+  while (ret && engine->stack_size > 0) {
+    DfsFrame *top = &engine->stack[engine->stack_size - 1];
+    if (top->iter && hashset_iter_has_next(top->iter)) {
+      Edge *edge = set_entry_key(hashset_next_entry(top->iter));
+      DfsMark *mark = get_hash_table(engine->marks, &edge->to);
+      DfsEdgeType type;
+      if (!mark) {
+        type = DFS_TREE_EDGE;
+      } else if (!mark->finished) {
+        type = DFS_BACK_EDGE;
+      } else if (mark->ord > top->ord) {
+        type = DFS_FORWARD_EDGE;
+      } else {
+        type = DFS_CROSS_EDGE;
+      }
+      int result = handler->edge ? handler->edge(handler->ctx, edge, type, top->pid) : VISIT_CONTINUE;
+      if (result == VISIT_STOP) {
+        ret = 0;
+      } else if (type == DFS_TREE_EDGE && result != VISIT_SKIP) {
+        ret = dfs_engine_discover(engine, edge->to, top->id, handler);
+      }
+    } else {
+      DfsFrame frame = *top;
+      engine->stack_size--;
+      if (frame.iter) free_hashset_iter(frame.iter);
+      ((DfsMark *) get_hash_table(engine->marks, &frame.id))->finished = 1;
+      if (handler->post_visit && handler->post_visit(handler->ctx, frame.id, frame.pid) == VISIT_STOP) {
+        ret = 0;
+      }
+    }
+  }
+  // unwind after a stop
+  while (engine->stack_size > 0) {
+    DfsFrame *top = &engine->stack[--engine->stack_size];
+    if (top->iter) free_hashset_iter(top->iter);
+  }
+  return ret;
+}
+
+static int dfs_post_order(void *ctx, int id, int pid) {
+  (void) pid;
+  VertexEntry *vertex_entry = ctx;
+  vertex_entry->id_list[vertex_entry->size++] = id;
+  return 1;
+}
+
 /**
  * dfs a graph using post order
- * @param graph
- * @param visited
+ * @param engine
  * @param id
  * @param vertex_entry
  */
-static void dfs(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry) {
-  put_hash_set(visited, new_id(id));
+static void dfs(DfsEngine *engine, int id, VertexEntry *vertex_entry) {
+  DfsHandler handler = {.post_visit=dfs_post_order, .ctx=vertex_entry};
+  dfs_engine_run(engine, id, &handler);
+}
 
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_set(visited, &edge->to)) {
-        dfs(graph, visited, edge->to, vertex_entry);
-      }
-    }
+typedef struct ComponentContext {
+  Hashtable *visited;
+  int cid;
+} ComponentContext;
 
-    free_hashset_iter(iterator);
-  }
-  vertex_entry->id_list[vertex_entry->size++] = id;
+static int dfs_cid_pre_visit(void *ctx, int id, int pid) {
+  (void) pid;
+  ComponentContext *c = ctx;
+  put_hash_table(c->visited, new_id(id), new_id(c->cid));
+  return 1;
 }
 
 /**
   * dfs with component id
   *
-  * @param graph
+  * @param engine
   * @param visited  hashmap for <vertex id, component id>
   * @param id       vertex id
   * @param cid      component id
   */
-static void dfs_cid(Graph *graph, Hashtable *visited, int id, int cid) {
-  put_hash_table(visited, new_id(id), new_id(cid));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_table(visited, &edge->to)) {
-        dfs_cid(graph, visited, edge->to, cid);
-      }
-    }
+static void dfs_cid(DfsEngine *engine, Hashtable *visited, int id, int cid) {
+  ComponentContext ctx = {.visited=visited, .cid=cid};
+  DfsHandler handler = {.pre_visit=dfs_cid_pre_visit, .ctx=&ctx};
+  dfs_engine_run(engine, id, &handler);
+}
 
-    free_hashset_iter(iterator);
-  }
+static int dfs_par_pre_visit(void *ctx, int id, int pid) {
+  put_hash_table(ctx, new_id(id), new_id(pid));
+  return 1;
 }
+
 /**
- * dfs with parent id
+ * dfs with parent id. the parent of id is itself.
  *
- * @param graph
+ * @param engine
  * @param par
  * @param id
- * @param pid
  */
-static void dfs_par(Graph *graph, Hashtable *par, int id, int pid) {
-  put_hash_table(par, new_id(id), new_id(pid));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_table(par, &edge->to)) {
-        dfs_par(graph, par, edge->to, id);
-      }
-    }
-
-    free_hashset_iter(iterator);
-  }
+static void dfs_par(DfsEngine *engine, Hashtable *par, int id) {
+  DfsHandler handler = {.pre_visit=dfs_par_pre_visit, .ctx=par};
+  dfs_engine_run(engine, id, &handler);
 }
 
 static void bfs_par(Graph *graph, Hashtable *par, int id, int pid) {
@@ -2311,100 +4160,56 @@ static void bfs_par(Graph *graph, Hashtable *par, int id, int pid) {
   free_dqueue(dqueue);
 }
 
+static int circle_undirected_edge(void *ctx, Edge *edge, DfsEdgeType type, int pid) {
+  (void) ctx;
+  return type == DFS_TREE_EDGE || edge->to == pid;
+}
+
 /**
  * test if undirected graph has circle
  *
- * @param graph
- * @param visited
+ * @param engine
  * @param id
- * @param pid
  * @return
  */
-static int dfs_circle_test_undirected(Graph *graph, Hashtable *visited, int id, int pid) {
-  put_hash_table(visited, new_id(id), new_id(pid));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      int is_visited = contains_in_hash_table(visited, &edge->to);
-      if (is_visited && edge->to != pid) {
-        free_hashset_iter(iterator);
-        return 1;
-      } else if (!visited) {
-        if (dfs_circle_test_undirected(graph, visited, edge->to, id)) {
-          free_hashset_iter(iterator);
-          return 1;
-        }
-      }
-    }
+static int dfs_circle_test_undirected(DfsEngine *engine, int id) {
+  DfsHandler handler = {.edge=circle_undirected_edge};
+  return !dfs_engine_run(engine, id, &handler);
+}
 
-    free_hashset_iter(iterator);
-  }
-  return 0;
+static int circle_directed_edge(void *ctx, Edge *edge, DfsEdgeType type, int pid) {
+  (void) ctx;
+  (void) edge;
+  (void) pid;
+  // a back edge goes to a vertex on the current path
+  return type != DFS_BACK_EDGE;
 }
 
-static int dfs_circle_test_directed(Graph *graph, Hashtable *visited, Hashset *on_path, int id, int pid) {
-  put_hash_table(visited, new_id(id), new_id(pid));
-  put_hash_set(on_path, new_id(id));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      int is_visited = contains_in_hash_table(visited, &edge->to);
-      if (!is_visited) {
-        if (dfs_circle_test_directed(graph, visited, on_path, edge->to, id)) {
-          free_hashset_iter(iterator);
-          return 1;
-        }
-      } else if (contains_in_hash_set(on_path, &edge->to)) {
-        free_hashset_iter(iterator);
-        return 1;
-      }
-    }
+static int dfs_circle_test_directed(DfsEngine *engine, int id) {
+  DfsHandler handler = {.edge=circle_directed_edge};
+  return !dfs_engine_run(engine, id, &handler);
+}
 
-    free_hashset_iter(iterator);
-  }
-  remove_hash_set(on_path, &id);
-  return 0;
+typedef struct PathContext {
+  Hashtable *par;
+  int target;
+} PathContext;
+
+static int dfs_cmp_pre_visit(void *ctx, int id, int pid) {
+  PathContext *c = ctx;
+  put_hash_table(c->par, new_id(id), new_id(pid));
+  return id != c->target;
 }
-static int dfs_cmp(Graph *graph, Hashtable *par, int id, int pid, int target) {
-  put_hash_table(par, new_id(id), new_id(pid));
-  if (id == target) {
-    return 1;
-  }
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_table(par, &edge->to)) {
-        if (dfs_cmp(graph, par, edge->to, id, target)) {
-          free_hashset_iter(iterator);
-          return 1;
-        }
-      }
-    }
 
-    free_hashset_iter(iterator);
-  }
-  return 0;
+static int dfs_cmp(DfsEngine *engine, Hashtable *par, int id, int target) {
+  PathContext ctx = {.par=par, .target=target};
+  DfsHandler handler = {.pre_visit=dfs_cmp_pre_visit, .ctx=&ctx};
+  return !dfs_engine_run(engine, id, &handler);
 }
 
-static void dfs_visit(Graph *graph, Hashset *visited, int id) {
-  put_hash_set(visited, new_id(id));
-  Hashset *adj = get_adj_set(graph, id);
-  if (adj) {
-    HashsetIterator *iterator = hashset_iterator(adj);
-    while (hashset_iter_has_next(iterator)) {
-      Edge *edge = set_entry_key(hashset_next_entry(iterator));
-      if (!contains_in_hash_set(visited, &edge->to)) {
-        dfs_visit(graph, visited, edge->to);
-      }
-    }
-    free_hashset_iter(iterator);
-  }
+static void dfs_visit(DfsEngine *engine, int id) {
+  DfsHandler handler = {0};
+  dfs_engine_run(engine, id, &handler);
 }
 
 static void dfs_nr(Graph *graph, Hashset *visited, int id, VertexEntry *vertex_entry) {
@@ -2611,30 +4416,6 @@ static int default_edge_equal_func(void *e1, void *e2) {
     return 1;
   }
 }
-static int edge_weight_compare(void *e1, void *e2) {
-  Edge *edge1 = (Edge *) e1;
-  Edge *edge2 = (Edge *) e2;
-  if (edge1->weight == edge2->weight) {
-    return 0;
-  } else if (edge1->weight < edge2->weight) {
-    return -1;
-  } else {
-    return 1;
-  }
-}
-
-static int edge_weight_compare_pq(void *e1, void *e2) {
-  Edge *edge1 = (Edge *) e1;
-  Edge *edge2 = (Edge *) e2;
-  if (edge1->weight == edge2->weight) {
-    return 0;
-  } else if (edge1->weight < edge2->weight) {
-    return 1;
-  } else {
-    return -1;
-  }
-}
-
 static int dis_compare_pq(DIS *d1, DIS *d2) {
   return d2->dis - d1->dis;
 }
@@ -2701,4 +4482,2343 @@ static int remove_edge_from_to(Hashset *hashset, int from_id, int to_id) {
   return removed;
 }
 
+// only renumber vertexes to slots, without any adjacency
+static CSR *create_csr_index(Graph *graph) {
+  CSR *csr = calloc(1, sizeof(CSR));
+  if (!csr) return NULL;
+  int n = graph->vertex_size;
+  csr->n = n;
+  csr->directed = graph->directed;
+  csr->ids = malloc(sizeof(int) * (n + 1));
+  csr->slots = new_hash_table(int_hash, int_compare);
+  int i = 0;
+  HashtableIterator *iter = hashtable_iterator(graph->represent);
+  while (hashtable_iter_has_next(iter)) {
+    int *id = table_entry_key(hashtable_next_entry(iter));
+    csr->ids[i] = *id;
+    // key and value both point into ids, the slot is the offset of the value
+    put_hash_table(csr->slots, &csr->ids[i], &csr->ids[i]);
+    i++;
+  }
+  free_hashtable_iter(iter);
+  return csr;
+}
+
+static CSR *create_csr(Graph *graph) {
+  CSR *csr = create_csr_index(graph);
+  if (!csr) return NULL;
+  int n = csr->n;
+  int i;
+  csr->offset = malloc(sizeof(int) * (n + 1));
+  csr->offset[0] = 0;
+  for (i = 0; i < n; ++i) {
+    Hashset *adj = get_adj_set(graph, csr->ids[i]);
+    csr->offset[i + 1] = csr->offset[i] + (adj ? size_of_hash_set(adj) : 0);
+  }
+  csr->m = csr->offset[n];
+  csr->adj = malloc(sizeof(int) * (csr->m + 1));
+  csr->weight = malloc(sizeof(int) * (csr->m + 1));
+  for (i = 0; i < n; ++i) {
+    Hashset *adj = get_adj_set(graph, csr->ids[i]);
+    if (!adj) continue;
+    int k = csr->offset[i];
+    HashsetIterator *iterator = hashset_iterator(adj);
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      csr->adj[k] = csr_slot(csr, edge->to);
+      csr->weight[k] = edge->weight;
+      k++;
+    }
+    free_hashset_iter(iterator);
+  }
+  return csr;
+}
+
+static void csr_build_in(CSR *csr) {
+  if (csr->in_offset) return;
+  if (!csr->directed) {
+    csr->in_offset = csr->offset;
+    csr->in_adj = csr->adj;
+    csr->in_weight = csr->weight;
+    return;
+  }
+  int n = csr->n;
+  int *in_offset = calloc(n + 1, sizeof(int));
+  int *in_adj = malloc(sizeof(int) * (csr->m + 1));
+  int *in_weight = malloc(sizeof(int) * (csr->m + 1));
+  for (int k = 0; k < csr->m; ++k) {
+    in_offset[csr->adj[k] + 1]++;
+  }
+  for (int v = 0; v < n; ++v) {
+    in_offset[v + 1] += in_offset[v];
+  }
+  int *pos = malloc(sizeof(int) * (n + 1));
+  memcpy(pos, in_offset, sizeof(int) * (n + 1));
+  for (int v = 0; v < n; ++v) {
+    for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      int p = pos[csr->adj[k]]++;
+      in_adj[p] = v;
+      in_weight[p] = csr->weight[k];
+    }
+  }
+  free(pos);
+  csr->in_offset = in_offset;
+  csr->in_adj = in_adj;
+  csr->in_weight = in_weight;
+}
+
+static int csr_slot(CSR *csr, int id) {
+  int *p = get_hash_table(csr->slots, &id);
+  return p ? (int) (p - csr->ids) : -1;
+}
+
+static void free_csr(CSR *csr) {
+  if (!csr) return;
+  if (csr->directed && csr->in_offset) {
+    free(csr->in_offset);
+    free(csr->in_adj);
+    free(csr->in_weight);
+  }
+  free_hash_table(csr->slots);
+  free(csr->ids);
+  free(csr->offset);
+  free(csr->adj);
+  free(csr->weight);
+  free(csr);
+}
+
+/**
+ * convert a parent array over slots (-1 for unreached) to a map of <id,pid>
+ *
+ * @param csr
+ * @param parent
+ * @return
+ */
+static Hashtable *slot_parent_to_map(CSR *csr, int *parent) {
+  Hashtable *pre = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(pre, free, free);
+  for (int v = 0; v < csr->n; ++v) {
+    if (parent[v] >= 0) {
+      put_hash_table(pre, new_id(csr->ids[v]), new_id(csr->ids[parent[v]]));
+    }
+  }
+  return pre;
+}
+
+/**
+ * expand every vertex of the frontier along its out arcs.
+ *
+ * @return size of next frontier
+ */
+static int bfs_top_down_step(CSR *csr, int *parent, int *frontier, int frontier_size, int *next) {
+  int next_size = 0;
+  for (int i = 0; i < frontier_size; ++i) {
+    int u = frontier[i];
+    for (int k = csr->offset[u]; k < csr->offset[u + 1]; ++k) {
+      int v = csr->adj[k];
+      if (parent[v] < 0) {
+        parent[v] = u;
+        next[next_size++] = v;
+      }
+    }
+  }
+  return next_size;
+}
+
+/**
+ * every unvisited vertex looks for a parent in the frontier along its in arcs,
+ * and stops at the first one found.
+ *
+ * @return size of next frontier
+ */
+static int bfs_bottom_up_step(CSR *csr, int *parent, uint64_t *frontier, uint64_t *next) {
+  int next_size = 0;
+  for (int v = 0; v < csr->n; ++v) {
+    if (parent[v] >= 0) continue;
+    for (int k = csr->in_offset[v]; k < csr->in_offset[v + 1]; ++k) {
+      int u = csr->in_adj[k];
+      if (frontier[u >> 6] & (1ULL << (u & 63))) {
+        parent[v] = u;
+        next[v >> 6] |= 1ULL << (v & 63);
+        next_size++;
+        break;
+      }
+    }
+  }
+  return next_size;
+}
+static int resolve_threads(int threads) {
+  if (threads > 0) return threads;
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 0 ? (int) cores : 1;
+}
+
+typedef struct ParallelArg {
+  ParallelTask task;
+  void *ctx;
+  int tid;
+  int threads;
+} ParallelArg;
+
+static void *parallel_entry(void *arg) {
+  ParallelArg *a = arg;
+  a->task(a->ctx, a->tid, a->threads);
+  return NULL;
+}
+
+/**
+ * run task on threads threads and wait for all of them. the calling thread works as tid 0.
+ * if a thread can not be created, its share is run by the calling thread.
+ *
+ * @param threads
+ * @param task
+ * @param ctx
+ */
+static void parallel_run(int threads, ParallelTask task, void *ctx) {
+  if (threads <= 1) {
+    task(ctx, 0, 1);
+    return;
+  }
+  pthread_t *tids = malloc(sizeof(pthread_t) * threads);
+  ParallelArg *args = malloc(sizeof(ParallelArg) * threads);
+  int *created = calloc(threads, sizeof(int));
+  for (int i = 1; i < threads; ++i) {
+    args[i] = (ParallelArg) {.task=task, .ctx=ctx, .tid=i, .threads=threads};
+    created[i] = pthread_create(&tids[i], NULL, parallel_entry, &args[i]) == 0;
+  }
+  task(ctx, 0, threads);
+  for (int i = 1; i < threads; ++i) {
+    if (created[i]) {
+      pthread_join(tids[i], NULL);
+    } else {
+      task(ctx, i, threads);
+    }
+  }
+  free(created);
+  free(args);
+  free(tids);
+}
+
+static void int_array_push(IntArray *array, int value) {
+  if (array->size == array->capacity) {
+    array->capacity = array->capacity ? array->capacity * 2 : 64;
+    array->data = realloc(array->data, sizeof(int) * array->capacity);
+  }
+  array->data[array->size++] = value;
+}
+
+/**
+ * expand a share of the frontier. a vertex is claimed by the first thread whose CAS on its parent succeeds.
+ */
+static void par_bfs_level(void *ctx, int tid, int threads) {
+  (void) threads;
+  ParBfs *bfs = ctx;
+  CSR *csr = bfs->csr;
+  IntArray *next = &bfs->local[tid];
+  next->size = 0;
+  while (1) {
+    int start = atomic_fetch_add(&bfs->cursor, PAR_GRAIN);
+    if (start >= bfs->frontier_size) break;
+    int end = start + PAR_GRAIN < bfs->frontier_size ? start + PAR_GRAIN : bfs->frontier_size;
+    for (int i = start; i < end; ++i) {
+      int u = bfs->frontier[i];
+      for (int k = csr->offset[u]; k < csr->offset[u + 1]; ++k) {
+        int v = csr->adj[k];
+        if (atomic_load_explicit(&bfs->parent[v], memory_order_relaxed) >= 0) continue;
+        int expected = -1;
+        if (atomic_compare_exchange_strong(&bfs->parent[v], &expected, u)) {
+          int_array_push(next, v);
+        }
+      }
+    }
+  }
+}
+/**
+ * bfs from up to 64 * MS_BFS_WORDS sources at once. every vertex keeps a bitset of the sources that have seen it
+ * and of the sources whose frontier it is on, so one scan of an adjacency list serves all sources of the batch.
+ *
+ * @param csr
+ * @param sources       slots of sources
+ * @param source_size
+ * @param hops          source_size rows of csr->n hop distances
+ */
+static void ms_bfs_batch(CSR *csr, int *sources, int source_size, int *hops) {
+  int n = csr->n;
+  int words = (source_size + 63) / 64;
+  uint64_t *seen = calloc((size_t) n * words + 1, sizeof(uint64_t));
+  uint64_t *visit = calloc((size_t) n * words + 1, sizeof(uint64_t));
+  uint64_t *visit_next = calloc((size_t) n * words + 1, sizeof(uint64_t));
+  for (size_t i = 0; i < (size_t) source_size * n; ++i) {
+    hops[i] = -1;
+  }
+  for (int i = 0; i < source_size; ++i) {
+    int s = sources[i];
+    seen[(size_t) s * words + (i >> 6)] |= 1ULL << (i & 63);
+    visit[(size_t) s * words + (i >> 6)] |= 1ULL << (i & 63);
+    hops[(size_t) i * n + s] = 0;
+  }
+  int level = 0;
+  int active = 1;
+  while (active) {
+    level++;
+    // push frontier bitsets along arcs
+    for (int v = 0; v < n; ++v) {
+      uint64_t *from = visit + (size_t) v * words;
+      uint64_t any = 0;
+      for (int w = 0; w < words; ++w) {
+        any |= from[w];
+      }
+      if (!any) continue;
+      for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+        uint64_t *to = visit_next + (size_t) csr->adj[k] * words;
+        for (int w = 0; w < words; ++w) {
+          to[w] |= from[w];
+        }
+      }
+    }
+    // keep sources that reach a vertex for the first time
+    active = 0;
+    for (int v = 0; v < n; ++v) {
+      uint64_t *next = visit_next + (size_t) v * words;
+      uint64_t *s = seen + (size_t) v * words;
+      for (int w = 0; w < words; ++w) {
+        uint64_t fresh = next[w] & ~s[w];
+        next[w] = fresh;
+        s[w] |= fresh;
+        while (fresh) {
+          int i = (w << 6) + __builtin_ctzll(fresh);
+          hops[(size_t) i * n + v] = level;
+          fresh &= fresh - 1;
+          active = 1;
+        }
+      }
+    }
+    uint64_t *tmp = visit;
+    visit = visit_next;
+    visit_next = tmp;
+    memset(visit_next, 0, sizeof(uint64_t) * n * words);
+  }
+  free(seen);
+  free(visit);
+  free(visit_next);
+}
+
+static int visitor_discover(void *ctx, int id, int pid) {
+  GraphVisitor *visitor = ctx;
+  return visitor->discover ? visitor->discover(visitor->ctx, id, pid) : VISIT_CONTINUE;
+}
+
+static int visitor_finish(void *ctx, int id, int pid) {
+  GraphVisitor *visitor = ctx;
+  return visitor->finish ? visitor->finish(visitor->ctx, id, pid) : VISIT_CONTINUE;
+}
+
+static int visitor_examine_edge(void *ctx, Edge *edge, DfsEdgeType type, int pid) {
+  (void) type;
+  (void) pid;
+  GraphVisitor *visitor = ctx;
+  return visitor->examine_edge ? visitor->examine_edge(visitor->ctx, edge) : VISIT_CONTINUE;
+}
+
+static VertexLabel *new_vertex_label(int size) {
+  VertexLabel *vertex_label = malloc(sizeof(VertexLabel));
+  if (!vertex_label) return NULL;
+  vertex_label->id_list = malloc(sizeof(int) * (size > 0 ? size : 1));
+  vertex_label->label = malloc(sizeof(int) * (size > 0 ? size : 1));
+  if (!vertex_label->id_list || !vertex_label->label) {
+    free(vertex_label->id_list);
+    free(vertex_label->label);
+    free(vertex_label);
+    return NULL;
+  }
+  vertex_label->size = size;
+  return vertex_label;
+}
+
+// forget the vertexes touched by last search, O(touched)
+static void reset_search_workspace(SearchWorkspace *workspace) {
+  for (int i = 0; i < workspace->size; ++i) {
+    free(remove_hash_table(workspace->index, &workspace->ids[i]));
+  }
+  workspace->size = 0;
+  workspace->queue.size = 0;
+  workspace->heap_size = 0;
+}
+
+/**
+ * index of id in the workspace, the vertex is added if it is not touched yet.
+ *
+ * @param workspace
+ * @param id
+ * @param fresh   set to 1 if the vertex is added
+ * @return
+ */
+static int search_slot(SearchWorkspace *workspace, int id, int *fresh) {
+  IdSlot *slot = get_hash_table(workspace->index, &id);
+  if (slot) {
+    *fresh = 0;
+    return slot->idx;
+  }
+  if (workspace->size == workspace->capacity) {
+    workspace->capacity = workspace->capacity ? workspace->capacity * 2 : 64;
+    workspace->ids = realloc(workspace->ids, sizeof(int) * workspace->capacity);
+    workspace->label = realloc(workspace->label, sizeof(int) * workspace->capacity);
+    workspace->settled = realloc(workspace->settled, workspace->capacity);
+  }
+  slot = malloc(sizeof(IdSlot));
+  slot->id = id;
+  slot->idx = workspace->size++;
+  put_hash_table(workspace->index, &slot->id, slot);
+  workspace->ids[slot->idx] = id;
+  workspace->settled[slot->idx] = 0;
+  *fresh = 1;
+  return slot->idx;
+}
+
+// copy the touched vertexes listed in order
+static VertexLabel *search_result(SearchWorkspace *workspace, int *order, int size) {
+  VertexLabel *result = new_vertex_label(size);
+  if (!result) return NULL;
+  for (int i = 0; i < size; ++i) {
+    result->id_list[i] = workspace->ids[order[i]];
+    result->label[i] = workspace->label[order[i]];
+  }
+  return result;
+}
+
+static void search_heap_push(SearchWorkspace *workspace, int dis, int idx) {
+  if (workspace->heap_size == workspace->heap_capacity) {
+    workspace->heap_capacity = workspace->heap_capacity ? workspace->heap_capacity * 2 : 64;
+    workspace->heap = realloc(workspace->heap, sizeof(SearchHeapNode) * workspace->heap_capacity);
+  }
+  SearchHeapNode *heap = workspace->heap;
+  int i = workspace->heap_size++;
+  while (i > 0 && heap[(i - 1) / 2].dis > dis) {
+    heap[i] = heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap[i].dis = dis;
+  heap[i].idx = idx;
+}
+
+static SearchHeapNode search_heap_pop(SearchWorkspace *workspace) {
+  SearchHeapNode *heap = workspace->heap;
+  SearchHeapNode top = heap[0];
+  SearchHeapNode last = heap[--workspace->heap_size];
+  int i = 0;
+  int n = workspace->heap_size;
+  while (2 * i + 1 < n) {
+    int c = 2 * i + 1;
+    if (c + 1 < n && heap[c + 1].dis < heap[c].dis) c++;
+    if (heap[c].dis >= last.dis) break;
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = last;
+  return top;
+}
+
+/**
+ * one dfs tree of scc_pearce. frame arrays are the call stack of the recursive version, stack holds
+ * vertexes whose component is not done yet.
+ */
+static void scc_pearce_visit(Graph *graph, CSR *index, int root, int *rindex, int *frame_v,
+                             HashsetIterator **frame_iter, char *frame_root, int *stack, int *top, int *next_index,
+                             int *c) {
+  int depth;
+  rindex[root] = (*next_index)++;
+  Hashset *adj = get_adj_set(graph, index->ids[root]);
+  frame_v[0] = root;
+  frame_iter[0] = adj ? hashset_iterator(adj) : NULL;
+  frame_root[0] = 1;
+  depth = 1;
+  while (depth > 0) {
+    int v = frame_v[depth - 1];
+    HashsetIterator *iter = frame_iter[depth - 1];
+    if (iter && hashset_iter_has_next(iter)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iter));
+      int w = csr_slot(index, edge->to);
+      if (rindex[w] == 0) {
+        rindex[w] = (*next_index)++;
+        adj = get_adj_set(graph, edge->to);
+        frame_v[depth] = w;
+        frame_iter[depth] = adj ? hashset_iterator(adj) : NULL;
+        frame_root[depth] = 1;
+        depth++;
+      } else if (rindex[w] < rindex[v]) {
+        rindex[v] = rindex[w];
+        frame_root[depth - 1] = 0;
+      }
+      continue;
+    }
+    // v is finished
+    if (iter) free_hashset_iter(iter);
+    if (frame_root[depth - 1]) {
+      (*next_index)--;
+      while (*top > 0 && rindex[v] <= rindex[stack[*top - 1]]) {
+        int w = stack[--(*top)];
+        rindex[w] = *c;
+        (*next_index)--;
+      }
+      rindex[v] = *c;
+      (*c)--;
+    } else {
+      stack[(*top)++] = v;
+    }
+    depth--;
+    if (depth > 0) {
+      int p = frame_v[depth - 1];
+      if (rindex[v] < rindex[p]) {
+        rindex[p] = rindex[v];
+        frame_root[depth - 1] = 0;
+      }
+    }
+  }
+}
+
+// take frontier vertexes as single components and put neighbors losing their last in or out edge to next
+static void par_scc_trim(void *ctx, int tid, int threads) {
+  (void) threads;
+  ParScc *scc = ctx;
+  CSR *csr = scc->csr;
+  IntArray *next = &scc->local[tid];
+  next->size = 0;
+  while (1) {
+    int start = atomic_fetch_add(&scc->cursor, PAR_GRAIN);
+    if (start >= scc->frontier_size) break;
+    int end = start + PAR_GRAIN < scc->frontier_size ? start + PAR_GRAIN : scc->frontier_size;
+    for (int i = start; i < end; ++i) {
+      int v = scc->frontier[i];
+      int expected = -1;
+      if (!atomic_compare_exchange_strong(&scc->comp[v], &expected, -2)) continue;
+      atomic_store(&scc->comp[v], atomic_fetch_add(&scc->next_comp, 1));
+      for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+        int w = csr->adj[k];
+        if (atomic_load_explicit(&scc->comp[w], memory_order_relaxed) != -1) continue;
+        if (atomic_fetch_sub(&scc->in_deg[w], 1) == 1) {
+          int_array_push(next, w);
+        }
+      }
+      for (int k = csr->in_offset[v]; k < csr->in_offset[v + 1]; ++k) {
+        int u = csr->in_adj[k];
+        if (atomic_load_explicit(&scc->comp[u], memory_order_relaxed) != -1) continue;
+        if (atomic_fetch_sub(&scc->out_deg[u], 1) == 1) {
+          int_array_push(next, u);
+        }
+      }
+    }
+  }
+}
+
+// one level of reachability among vertexes whose component is not found
+static void par_scc_reach(void *ctx, int tid, int threads) {
+  (void) threads;
+  ParScc *scc = ctx;
+  CSR *csr = scc->csr;
+  int *offset = scc->out ? csr->offset : csr->in_offset;
+  int *adj = scc->out ? csr->adj : csr->in_adj;
+  IntArray *next = &scc->local[tid];
+  next->size = 0;
+  while (1) {
+    int start = atomic_fetch_add(&scc->cursor, PAR_GRAIN);
+    if (start >= scc->frontier_size) break;
+    int end = start + PAR_GRAIN < scc->frontier_size ? start + PAR_GRAIN : scc->frontier_size;
+    for (int i = start; i < end; ++i) {
+      int u = scc->frontier[i];
+      for (int k = offset[u]; k < offset[u + 1]; ++k) {
+        int v = adj[k];
+        if (atomic_load_explicit(&scc->comp[v], memory_order_relaxed) >= 0) continue;
+        if (atomic_load_explicit(&scc->mark[v], memory_order_relaxed)) continue;
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&scc->mark[v], &expected, 1)) {
+          int_array_push(next, v);
+        }
+      }
+    }
+  }
+}
+
+// every vertex left starts with its own slot as color. changed is set if any vertex is left
+static void par_scc_color_init(void *ctx, int tid, int threads) {
+  ParScc *scc = ctx;
+  int n = scc->csr->n;
+  int start = (int) ((long long) n * tid / threads);
+  int end = (int) ((long long) n * (tid + 1) / threads);
+  int left = 0;
+  for (int v = start; v < end; ++v) {
+    if (atomic_load_explicit(&scc->comp[v], memory_order_relaxed) < 0) {
+      atomic_store_explicit(&scc->color[v], v, memory_order_relaxed);
+      left = 1;
+    } else {
+      atomic_store_explicit(&scc->color[v], -1, memory_order_relaxed);
+    }
+  }
+  if (left) atomic_store(&scc->changed, 1);
+}
+
+// push the max color along out edges
+static void par_scc_color_propagate(void *ctx, int tid, int threads) {
+  ParScc *scc = ctx;
+  CSR *csr = scc->csr;
+  int n = csr->n;
+  int start = (int) ((long long) n * tid / threads);
+  int end = (int) ((long long) n * (tid + 1) / threads);
+  int changed = 0;
+  for (int v = start; v < end; ++v) {
+    int c = atomic_load_explicit(&scc->color[v], memory_order_relaxed);
+    if (c < 0) continue;
+    for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      int w = csr->adj[k];
+      int old = atomic_load_explicit(&scc->color[w], memory_order_relaxed);
+      while (old >= 0 && old < c) {
+        if (atomic_compare_exchange_weak(&scc->color[w], &old, c)) {
+          changed = 1;
+          break;
+        }
+      }
+    }
+  }
+  if (changed) atomic_store(&scc->changed, 1);
+}
+
+// vertexes of a color that reach its root backward are the component of the root
+static void par_scc_color_collect(void *ctx, int tid, int threads) {
+  (void) threads;
+  ParScc *scc = ctx;
+  CSR *csr = scc->csr;
+  int n = csr->n;
+  IntArray *stack = &scc->local[tid];
+  while (1) {
+    int start = atomic_fetch_add(&scc->cursor, PAR_GRAIN);
+    if (start >= n) break;
+    int end = start + PAR_GRAIN < n ? start + PAR_GRAIN : n;
+    for (int r = start; r < end; ++r) {
+      if (atomic_load_explicit(&scc->color[r], memory_order_relaxed) != r) continue;
+      // vertexes of color r are only touched by this thread
+      int cid = atomic_fetch_add(&scc->next_comp, 1);
+      atomic_store_explicit(&scc->comp[r], cid, memory_order_relaxed);
+      stack->size = 0;
+      int_array_push(stack, r);
+      while (stack->size > 0) {
+        int v = stack->data[--stack->size];
+        for (int k = csr->in_offset[v]; k < csr->in_offset[v + 1]; ++k) {
+          int u = csr->in_adj[k];
+          if (atomic_load_explicit(&scc->color[u], memory_order_relaxed) != r) continue;
+          if (atomic_load_explicit(&scc->comp[u], memory_order_relaxed) >= 0) continue;
+          atomic_store_explicit(&scc->comp[u], cid, memory_order_relaxed);
+          int_array_push(stack, u);
+        }
+      }
+    }
+  }
+}
+
+// add a singleton at slot uf->size
+static void dense_uf_add(DenseUF *uf) {
+  if (uf->size == uf->capacity) {
+    uf->capacity = uf->capacity ? uf->capacity * 2 : 64;
+    uf->parent = realloc(uf->parent, sizeof(int) * uf->capacity);
+    uf->rank = realloc(uf->rank, uf->capacity);
+  }
+  uf->parent[uf->size] = uf->size;
+  uf->rank[uf->size] = 0;
+  uf->size++;
+  uf->count++;
+}
+
+static int dense_uf_find(DenseUF *uf, int x) {
+  while (uf->parent[x] != x) {
+    // path halving
+    uf->parent[x] = uf->parent[uf->parent[x]];
+    x = uf->parent[x];
+  }
+  return x;
+}
+
+// return 1 if two sets are merged
+static int dense_uf_union(DenseUF *uf, int x, int y) {
+  x = dense_uf_find(uf, x);
+  y = dense_uf_find(uf, y);
+  if (x == y) return 0;
+  if (uf->rank[x] < uf->rank[y]) {
+    int tmp = x;
+    x = y;
+    y = tmp;
+  }
+  uf->parent[y] = x;
+  if (uf->rank[x] == uf->rank[y]) uf->rank[x]++;
+  uf->count--;
+  return 1;
+}
+
+static void dense_uf_free(DenseUF *uf) {
+  free(uf->parent);
+  free(uf->rank);
+}
+
+// slot of id, -1 if id is not in uf and add is 0
+static int id_uf_slot(IdUnionFind *uf, int id, int add) {
+  IdSlot *slot = get_hash_table(uf->index, &id);
+  if (slot) return slot->idx;
+  if (!add) return -1;
+  int capacity = uf->uf.capacity;
+  dense_uf_add(&uf->uf);
+  if (uf->uf.capacity != capacity) {
+    uf->ids = realloc(uf->ids, sizeof(int) * uf->uf.capacity);
+  }
+  slot = malloc(sizeof(IdSlot));
+  slot->id = id;
+  slot->idx = uf->uf.size - 1;
+  put_hash_table(uf->index, &slot->id, slot);
+  uf->ids[slot->idx] = id;
+  return slot->idx;
+}
+
+// a set for every slot of index, then union the ends of every edge
+static void uf_over_edges(Graph *graph, CSR *index, DenseUF *uf) {
+  for (int v = 0; v < index->n; ++v) {
+    dense_uf_add(uf);
+  }
+  HashtableIterator *iter = hashtable_iterator(graph->edges);
+  while (hashtable_iter_has_next(iter)) {
+    KVEntry *entry = hashtable_next_entry(iter);
+    int from = csr_slot(index, *(int *) table_entry_key(entry));
+    HashsetIterator *iterator = hashset_iterator(table_entry_value(entry));
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      dense_uf_union(uf, from, csr_slot(index, edge->to));
+    }
+    free_hashset_iter(iterator);
+  }
+  free_hashtable_iter(iter);
+}
+
+static int int_qsort_compare(const void *a, const void *b) {
+  int x = *(const int *) a;
+  int y = *(const int *) b;
+  return (x > y) - (x < y);
+}
+
+// hook the trees of u and v, the larger root is put under the smaller one
+static void afforest_link(atomic_int *comp, int u, int v) {
+  int p1 = atomic_load_explicit(&comp[u], memory_order_relaxed);
+  int p2 = atomic_load_explicit(&comp[v], memory_order_relaxed);
+  while (p1 != p2) {
+    int high = p1 > p2 ? p1 : p2;
+    int low = p1 + p2 - high;
+    int p_high = atomic_load_explicit(&comp[high], memory_order_relaxed);
+    if (p_high == low) break;
+    if (p_high == high && atomic_compare_exchange_strong(&comp[high], &p_high, low)) break;
+    p1 = atomic_load_explicit(&comp[atomic_load_explicit(&comp[high], memory_order_relaxed)],
+                              memory_order_relaxed);
+    p2 = atomic_load_explicit(&comp[low], memory_order_relaxed);
+  }
+}
+
+// link every vertex with its round-th out edge
+static void afforest_neighbor_round(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Afforest *af = ctx;
+  CSR *csr = af->csr;
+  while (1) {
+    int start = atomic_fetch_add(&af->cursor, PAR_GRAIN);
+    if (start >= csr->n) break;
+    int end = start + PAR_GRAIN < csr->n ? start + PAR_GRAIN : csr->n;
+    for (int v = start; v < end; ++v) {
+      int k = csr->offset[v] + af->round;
+      if (k < csr->offset[v + 1]) {
+        afforest_link(af->comp, v, csr->adj[k]);
+      }
+    }
+  }
+}
+
+// point every vertex to its root
+static void afforest_compress(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Afforest *af = ctx;
+  int n = af->csr->n;
+  while (1) {
+    int start = atomic_fetch_add(&af->cursor, PAR_GRAIN);
+    if (start >= n) break;
+    int end = start + PAR_GRAIN < n ? start + PAR_GRAIN : n;
+    for (int v = start; v < end; ++v) {
+      int p = atomic_load_explicit(&af->comp[v], memory_order_relaxed);
+      int pp = atomic_load_explicit(&af->comp[p], memory_order_relaxed);
+      while (p != pp) {
+        atomic_store_explicit(&af->comp[v], pp, memory_order_relaxed);
+        p = pp;
+        pp = atomic_load_explicit(&af->comp[p], memory_order_relaxed);
+      }
+    }
+  }
+}
+
+// vertexes outside of the skipped component link along the rest of their edges
+static void afforest_finish(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Afforest *af = ctx;
+  CSR *csr = af->csr;
+  while (1) {
+    int start = atomic_fetch_add(&af->cursor, PAR_GRAIN);
+    if (start >= csr->n) break;
+    int end = start + PAR_GRAIN < csr->n ? start + PAR_GRAIN : csr->n;
+    for (int v = start; v < end; ++v) {
+      if (atomic_load_explicit(&af->comp[v], memory_order_relaxed) == af->skip) continue;
+      for (int k = csr->offset[v] + AFFOREST_ROUNDS; k < csr->offset[v + 1]; ++k) {
+        afforest_link(af->comp, v, csr->adj[k]);
+      }
+      if (csr->directed) {
+        // an in edge from the skipped component is not seen from the other end
+        for (int k = csr->in_offset[v]; k < csr->in_offset[v + 1]; ++k) {
+          afforest_link(af->comp, v, csr->in_adj[k]);
+        }
+      }
+    }
+  }
+}
+
+// rebuild the connectivity index from all vertexes and edges if it is stale
+static IdUnionFind *fresh_connectivity(Graph *graph) {
+  if (!graph->connectivity_stale) return graph->connectivity;
+  free_id_uf(graph->connectivity);
+  IdUnionFind *uf = create_id_uf();
+  HashtableIterator *iter = hashtable_iterator(graph->represent);
+  while (hashtable_iter_has_next(iter)) {
+    id_uf_add(uf, *(int *) table_entry_key(hashtable_next_entry(iter)));
+  }
+  free_hashtable_iter(iter);
+  iter = hashtable_iterator(graph->edges);
+  while (hashtable_iter_has_next(iter)) {
+    HashsetIterator *iterator = hashset_iterator(table_entry_value(hashtable_next_entry(iter)));
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      id_uf_union(uf, edge->from, edge->to);
+    }
+    free_hashset_iter(iterator);
+  }
+  free_hashtable_iter(iter);
+  graph->connectivity = uf;
+  graph->connectivity_stale = 0;
+  return uf;
+}
+
+static void free_dynamic_connectivity(DynamicConnectivity *dc) {
+  if (!dc) return;
+  HashtableIterator *iter = hashtable_iterator(dc->tree);
+  while (hashtable_iter_has_next(iter)) {
+    TreeArc *arc = table_entry_value(hashtable_next_entry(iter));
+    free(arc->uv);
+    free(arc->vu);
+  }
+  free_hashtable_iter(iter);
+  for (int i = 0; i < dc->size; ++i) {
+    free(dc->nodes[i]);
+  }
+  free_hash_table(dc->tree);
+  free_hash_table(dc->index);
+  free(dc->ids);
+  free(dc->nodes);
+  free(dc);
+}
+
+static EttNode *dyn_node(DynamicConnectivity *dc, int id) {
+  IdSlot *slot = get_hash_table(dc->index, &id);
+  return slot ? dc->nodes[slot->idx] : NULL;
+}
+
+static void dyn_add_vertex(DynamicConnectivity *dc, int id) {
+  if (contains_in_hash_table(dc->index, &id)) return;
+  if (dc->size == dc->capacity) {
+    dc->capacity = dc->capacity ? dc->capacity * 2 : 64;
+    dc->ids = realloc(dc->ids, sizeof(int) * dc->capacity);
+    dc->nodes = realloc(dc->nodes, sizeof(EttNode *) * dc->capacity);
+  }
+  IdSlot *slot = malloc(sizeof(IdSlot));
+  slot->id = id;
+  slot->idx = dc->size++;
+  put_hash_table(dc->index, &slot->id, slot);
+  dc->ids[slot->idx] = id;
+  dc->nodes[slot->idx] = ett_new_node(dc, slot->idx);
+  dc->vertex_count++;
+}
+
+// the vertex must have no edge left
+static void dyn_remove_vertex(DynamicConnectivity *dc, int id) {
+  IdSlot *slot = remove_hash_table(dc->index, &id);
+  if (!slot) return;
+  free(dc->nodes[slot->idx]);
+  dc->nodes[slot->idx] = NULL;
+  dc->vertex_count--;
+  free(slot);
+}
+
+static void dyn_insert_edge(DynamicConnectivity *dc, int from, int to) {
+  EttNode *u = dyn_node(dc, from);
+  EttNode *v = dyn_node(dc, to);
+  if (ett_root(u) == ett_root(v)) {
+    ett_add_nontree(u, 1);
+    ett_add_nontree(v, 1);
+  } else {
+    ett_link(dc, from, to);
+  }
+}
+
+/**
+ * the edge is already removed from graph. if it is a tree edge, look for a replacement among the non-tree
+ * edges of the smaller of the two trees left.
+ */
+static void dyn_delete_edge(Graph *graph, int from, int to) {
+  DynamicConnectivity *dc = graph->dynamic;
+  Edge key = {.from=from < to ? from : to, .to=from < to ? to : from};
+  TreeArc *arc = get_hash_table(dc->tree, &key);
+  if (!arc) {
+    ett_add_nontree(dyn_node(dc, from), -1);
+    ett_add_nontree(dyn_node(dc, to), -1);
+    return;
+  }
+  ett_cut(dc, arc);
+  EttNode *a = ett_root(dyn_node(dc, from));
+  EttNode *b = ett_root(dyn_node(dc, to));
+  EttNode *small = a->vertices <= b->vertices ? a : b;
+  if (small->nontree == 0) return;
+  // walk subtrees holding non-tree edges only
+  EttNode **stack = malloc(sizeof(EttNode *) * 64);
+  int capacity = 64;
+  int top = 0;
+  stack[top++] = small;
+  int found = 0;
+  while (top > 0 && !found) {
+    EttNode *x = stack[--top];
+    if (x->own_nontree > 0) {
+      int id = dc->ids[x->slot];
+      HashsetIterator *iter = hashset_iterator(get_adj_set(graph, id));
+      while (hashset_iter_has_next(iter)) {
+        Edge *edge = set_entry_key(hashset_next_entry(iter));
+        Edge k = {.from=id < edge->to ? id : edge->to, .to=id < edge->to ? edge->to : id};
+        if (contains_in_hash_table(dc->tree, &k)) continue;
+        EttNode *y = dyn_node(dc, edge->to);
+        if (ett_root(y) == small) continue;
+        ett_add_nontree(x, -1);
+        ett_add_nontree(y, -1);
+        ett_link(dc, id, edge->to);
+        found = 1;
+        break;
+      }
+      free_hashset_iter(iter);
+    }
+    if (top + 2 > capacity) {
+      capacity *= 2;
+      stack = realloc(stack, sizeof(EttNode *) * capacity);
+    }
+    if (x->left && x->left->nontree > 0) stack[top++] = x->left;
+    if (x->right && x->right->nontree > 0) stack[top++] = x->right;
+  }
+  free(stack);
+}
+
+static int dyn_connected(DynamicConnectivity *dc, int id1, int id2) {
+  EttNode *u = dyn_node(dc, id1);
+  EttNode *v = dyn_node(dc, id2);
+  return u && v && ett_root(u) == ett_root(v);
+}
+
+static EttNode *ett_new_node(DynamicConnectivity *dc, int slot) {
+  EttNode *x = calloc(1, sizeof(EttNode));
+  // xorshift
+  dc->seed ^= dc->seed << 13;
+  dc->seed ^= dc->seed >> 17;
+  dc->seed ^= dc->seed << 5;
+  x->priority = dc->seed;
+  x->slot = slot;
+  ett_update(x);
+  return x;
+}
+
+static void ett_update(EttNode *x) {
+  x->size = 1;
+  x->vertices = x->slot >= 0;
+  x->nontree = x->own_nontree;
+  if (x->left) {
+    x->size += x->left->size;
+    x->vertices += x->left->vertices;
+    x->nontree += x->left->nontree;
+  }
+  if (x->right) {
+    x->size += x->right->size;
+    x->vertices += x->right->vertices;
+    x->nontree += x->right->nontree;
+  }
+}
+
+static EttNode *ett_root(EttNode *x) {
+  while (x->parent) x = x->parent;
+  return x;
+}
+
+// index of x in its tour
+static int ett_position(EttNode *x) {
+  int k = x->left ? x->left->size : 0;
+  while (x->parent) {
+    if (x == x->parent->right) {
+      k += 1 + (x->parent->left ? x->parent->left->size : 0);
+    }
+    x = x->parent;
+  }
+  return k;
+}
+
+static EttNode *ett_merge(EttNode *a, EttNode *b) {
+  if (!a) return b;
+  if (!b) return a;
+  if (a->priority > b->priority) {
+    a->right = ett_merge(a->right, b);
+    a->right->parent = a;
+    ett_update(a);
+    return a;
+  }
+  b->left = ett_merge(a, b->left);
+  b->left->parent = b;
+  ett_update(b);
+  return b;
+}
+
+// first k nodes of t to l, the rest to r. parents of l and r are cleared
+static void ett_split(EttNode *t, int k, EttNode **l, EttNode **r) {
+  if (!t) {
+    *l = *r = NULL;
+    return;
+  }
+  int left_size = t->left ? t->left->size : 0;
+  if (k <= left_size) {
+    EttNode *left = t->left;
+    if (left) left->parent = NULL;
+    ett_split(left, k, l, &t->left);
+    if (t->left) t->left->parent = t;
+    ett_update(t);
+    *r = t;
+  } else {
+    EttNode *right = t->right;
+    if (right) right->parent = NULL;
+    ett_split(right, k - left_size - 1, &t->right, r);
+    if (t->right) t->right->parent = t;
+    ett_update(t);
+    *l = t;
+  }
+  if (*l) (*l)->parent = NULL;
+  if (*r) (*r)->parent = NULL;
+}
+
+// rotate the tour so that it starts at x
+static void ett_reroot(EttNode *x) {
+  EttNode *root = ett_root(x);
+  EttNode *l, *r;
+  ett_split(root, ett_position(x), &l, &r);
+  ett_merge(r, l)->parent = NULL;
+}
+
+static void ett_add_nontree(EttNode *x, int delta) {
+  x->own_nontree += delta;
+  for (; x; x = x->parent) {
+    ett_update(x);
+  }
+}
+
+static void ett_link(DynamicConnectivity *dc, int from, int to) {
+  EttNode *u = dyn_node(dc, from);
+  EttNode *v = dyn_node(dc, to);
+  ett_reroot(u);
+  ett_reroot(v);
+  TreeArc *arc = malloc(sizeof(TreeArc));
+  arc->edge.from = from < to ? from : to;
+  arc->edge.to = from < to ? to : from;
+  arc->edge.weight = 0;
+  arc->uv = ett_new_node(dc, -1);
+  arc->vu = ett_new_node(dc, -1);
+  EttNode *t = ett_merge(ett_merge(ett_root(u), arc->uv), ett_merge(ett_root(v), arc->vu));
+  t->parent = NULL;
+  put_hash_table(dc->tree, &arc->edge, arc);
+  dc->tree_edges++;
+}
+
+// tour is L uv M vu R, M is one tree and L R is the other
+static void ett_cut(DynamicConnectivity *dc, TreeArc *arc) {
+  EttNode *first = arc->uv;
+  EttNode *second = arc->vu;
+  int p1 = ett_position(first);
+  int p2 = ett_position(second);
+  if (p1 > p2) {
+    EttNode *tmp = first;
+    first = second;
+    second = tmp;
+    int t = p1;
+    p1 = p2;
+    p2 = t;
+  }
+  EttNode *left, *rest, *middle, *right, *node;
+  ett_split(ett_root(first), p2, &left, &rest);
+  ett_split(rest, 1, &node, &right);
+  ett_split(left, p1, &left, &rest);
+  ett_split(rest, 1, &node, &middle);
+  EttNode *t = ett_merge(left, right);
+  if (t) t->parent = NULL;
+  if (middle) middle->parent = NULL;
+  free(remove_hash_table(dc->tree, &arc->edge));
+  free(first);
+  free(second);
+  dc->tree_edges--;
+}
+
+/**
+ * build LcaForest of n nodes from m undirected edges <edges[2 * i], edges[2 * i + 1]> that form a forest.
+ * every tree is rooted at its lowest node.
+ */
+static LcaForest *create_lca_forest(int n, int *edges, int m) {
+  LcaForest *forest = malloc(sizeof(LcaForest));
+  if (!forest) return NULL;
+  forest->n = n;
+  forest->levels = 1;
+  while ((1 << forest->levels) < n) {
+    forest->levels++;
+  }
+  forest->up = malloc(sizeof(int) * ((size_t) forest->levels * n + 1));
+  forest->depth = malloc(sizeof(int) * (n + 1));
+  forest->tin = malloc(sizeof(int) * (n + 1));
+  forest->tout = malloc(sizeof(int) * (n + 1));
+  forest->root = malloc(sizeof(int) * (n + 1));
+
+  int *offset = calloc(n + 2, sizeof(int));
+  int *adj = malloc(sizeof(int) * (2 * m + 1));
+  for (int i = 0; i < 2 * m; ++i) {
+    offset[edges[i] + 2]++;
+  }
+  for (int v = 0; v < n; ++v) {
+    offset[v + 2] += offset[v + 1];
+  }
+  for (int i = 0; i < m; ++i) {
+    adj[offset[edges[2 * i] + 1]++] = edges[2 * i + 1];
+    adj[offset[edges[2 * i + 1] + 1]++] = edges[2 * i];
+  }
+
+  int *stack = malloc(sizeof(int) * (n + 1));
+  int *next = malloc(sizeof(int) * (n + 1));
+  int timer = 0;
+  for (int v = 0; v < n; ++v) {
+    forest->tin[v] = -1;
+  }
+  for (int r = 0; r < n; ++r) {
+    if (forest->tin[r] >= 0) continue;
+    forest->tin[r] = timer++;
+    forest->up[r] = r;
+    forest->depth[r] = 0;
+    forest->root[r] = r;
+    next[r] = offset[r];
+    int top = 0;
+    stack[top++] = r;
+    while (top > 0) {
+      int v = stack[top - 1];
+      if (next[v] < offset[v + 1]) {
+        int w = adj[next[v]++];
+        if (forest->tin[w] < 0) {
+          forest->tin[w] = timer++;
+          forest->up[w] = v;
+          forest->depth[w] = forest->depth[v] + 1;
+          forest->root[w] = r;
+          next[w] = offset[w];
+          stack[top++] = w;
+        }
+      } else {
+        forest->tout[v] = timer++;
+        top--;
+      }
+    }
+  }
+  for (int k = 1; k < forest->levels; ++k) {
+    int *prev = forest->up + (size_t) (k - 1) * n;
+    int *cur = forest->up + (size_t) k * n;
+    for (int v = 0; v < n; ++v) {
+      cur[v] = prev[prev[v]];
+    }
+  }
+  free(offset);
+  free(adj);
+  free(stack);
+  free(next);
+  return forest;
+}
+
+static int lca_is_ancestor(LcaForest *forest, int u, int v) {
+  return forest->tin[u] <= forest->tin[v] && forest->tout[v] <= forest->tout[u];
+}
+
+// lowest common ancestor of u and v in the same tree
+static int lca_forest_lca(LcaForest *forest, int u, int v) {
+  if (lca_is_ancestor(forest, u, v)) return u;
+  if (lca_is_ancestor(forest, v, u)) return v;
+  for (int k = forest->levels - 1; k >= 0; --k) {
+    int w = forest->up[(size_t) k * forest->n + u];
+    if (!lca_is_ancestor(forest, w, v)) u = w;
+  }
+  return forest->up[u];
+}
+
+static void free_lca_forest(LcaForest *forest) {
+  if (forest) {
+    free(forest->up);
+    free(forest->depth);
+    free(forest->tin);
+    free(forest->tout);
+    free(forest->root);
+    free(forest);
+  }
+}
+
+/**
+ * strong bridges and strong articulation points of directed graph (Italiano, Laura and Santaroni), by dominators
+ * of every strongly connected component on the graph and its reverse, from the first vertex s of the component.
+ * <u, v> is a bridge of flow graph G(s) iff u = idom(v) and v dominates its other predecessors. A vertex other
+ * than s is a strong articulation point iff it is a non-trivial dominator in G(s) or reverse G(s). s is one iff
+ * the component without s is not strongly connected.
+ *
+ * @param graph
+ * @param bridges   pairs of from, to of the strong bridges, can be NULL
+ * @param points    ids of the strong articulation points, can be NULL
+ */
+static void find_strong_cuts(Graph *graph, IntArray *bridges, IntArray *points) {
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  int m = csr->m;
+  VertexLabel *scc = scc_pearce(graph);
+  int *comp = malloc(sizeof(int) * (n + 1));
+  int comp_size = 0;
+  for (int i = 0; i < scc->size; ++i) {
+    comp[csr_slot(csr, scc->id_list[i])] = scc->label[i];
+    if (scc->label[i] >= comp_size) comp_size = scc->label[i] + 1;
+  }
+  free_vertex_label(scc);
+
+  // vertexes of component c are order[start[c]] ... order[start[c + 1] - 1], local is the position among them
+  int *start = calloc(comp_size + 2, sizeof(int));
+  int *order = malloc(sizeof(int) * (n + 1));
+  int *local = malloc(sizeof(int) * (n + 1));
+  for (int v = 0; v < n; ++v) {
+    start[comp[v] + 2]++;
+  }
+  for (int c = 0; c < comp_size; ++c) {
+    start[c + 2] += start[c + 1];
+  }
+  for (int v = 0; v < n; ++v) {
+    order[start[comp[v] + 1]++] = v;
+  }
+  for (int i = 0; i < n; ++i) {
+    local[order[i]] = i - start[comp[order[i]]];
+  }
+
+  // arcs inside the component, out arcs indexed by arc, in arcs refer to the out arc by in_arc
+  int *offset = malloc(sizeof(int) * (n + 1));
+  int *adj = malloc(sizeof(int) * (m + 1));
+  int *in_offset = malloc(sizeof(int) * (n + 1));
+  int *in_adj = malloc(sizeof(int) * (m + 1));
+  int *in_arc = malloc(sizeof(int) * (m + 1));
+  int *idom = malloc(sizeof(int) * (n + 1));
+  int *queue = malloc(sizeof(int) * (n + 1));
+  char *bridge = malloc(m + 1);
+  char *cut = malloc(n + 1);
+  char *mark = malloc(n + 1);
+  char *is_cut = calloc(n + 1, 1);
+
+  for (int c = 0; c < comp_size; ++c) {
+    int *vertices = order + start[c];
+    int k = start[c + 1] - start[c];
+    if (k < 2) continue;
+    int arcs = 0;
+    offset[0] = 0;
+    memset(in_offset, 0, sizeof(int) * (k + 1));
+    for (int v = 0; v < k; ++v) {
+      int g = vertices[v];
+      for (int e = csr->offset[g]; e < csr->offset[g + 1]; ++e) {
+        if (comp[csr->adj[e]] != c) continue;
+        adj[arcs++] = local[csr->adj[e]];
+        in_offset[local[csr->adj[e]] + 1]++;
+      }
+      offset[v + 1] = arcs;
+    }
+    for (int v = 0; v < k; ++v) {
+      in_offset[v + 1] += in_offset[v];
+    }
+    for (int v = 0; v < k; ++v) {
+      for (int e = offset[v]; e < offset[v + 1]; ++e) {
+        // in_offset[w] is moved to the end of the in arcs of w while filling, then shifted back
+        int p = in_offset[adj[e]]++;
+        in_adj[p] = v;
+        in_arc[p] = e;
+      }
+    }
+    for (int v = k; v > 0; --v) {
+      in_offset[v] = in_offset[v - 1];
+    }
+    in_offset[0] = 0;
+
+    memset(bridge, 0, arcs);
+    memset(cut, 0, k);
+    dominators(k, offset, adj, in_offset, in_adj, 0, idom);
+    flow_graph_cuts(k, in_offset, in_adj, in_arc, idom, bridge, cut);
+    dominators(k, in_offset, in_adj, offset, adj, 0, idom);
+    flow_graph_cuts(k, offset, adj, NULL, idom, bridge, cut);
+    if (reach_without(k, offset, adj, 1, 0, mark, queue) < k - 1
+        || reach_without(k, in_offset, in_adj, 1, 0, mark, queue) < k - 1) {
+      cut[0] = 1;
+    }
+
+    for (int v = 0; v < k; ++v) {
+      if (cut[v]) is_cut[vertices[v]] = 1;
+      if (!bridges) continue;
+      for (int e = offset[v]; e < offset[v + 1]; ++e) {
+        if (bridge[e]) {
+          int_array_push(bridges, csr->ids[vertices[v]]);
+          int_array_push(bridges, csr->ids[vertices[adj[e]]]);
+        }
+      }
+    }
+  }
+  if (points) {
+    for (int v = 0; v < n; ++v) {
+      if (is_cut[v]) int_array_push(points, csr->ids[v]);
+    }
+  }
+
+  free(comp);
+  free(start);
+  free(order);
+  free(local);
+  free(offset);
+  free(adj);
+  free(in_offset);
+  free(in_adj);
+  free(in_arc);
+  free(idom);
+  free(queue);
+  free(bridge);
+  free(cut);
+  free(mark);
+  free(is_cut);
+  free_csr(csr);
+}
+
+/**
+ * immediate dominators of flow graph from root by Lengauer-Tarjan with path compression, no recursion.
+ * vertexes are [0, n), arcs are given by both out and in adjacency arrays.
+ *
+ * @param idom  idom of every vertex, root for root, -1 if not reachable
+ */
+static void dominators(int n, int *offset, int *adj, int *in_offset, int *in_adj, int root, int *idom) {
+  int *dfn = malloc(sizeof(int) * (n + 1));      // preorder number, -1 if not reachable
+  int *vertex = malloc(sizeof(int) * (n + 1));   // vertex of preorder number
+  int *parent = malloc(sizeof(int) * (n + 1));
+  int *semi = malloc(sizeof(int) * (n + 1));     // preorder number of the semi-dominator
+  int *label = malloc(sizeof(int) * (n + 1));
+  int *ancestor = malloc(sizeof(int) * (n + 1)); // forest of processed vertexes, compressed by eval
+  int *bucket = malloc(sizeof(int) * (n + 1));   // head of vertexes whose semi-dominator is the vertex
+  int *bucket_next = malloc(sizeof(int) * (n + 1));
+  int *stack = malloc(sizeof(int) * (n + 1));
+  int *next = malloc(sizeof(int) * (n + 1));
+  for (int v = 0; v < n; ++v) {
+    dfn[v] = -1;
+    idom[v] = -1;
+    ancestor[v] = -1;
+    bucket[v] = -1;
+    label[v] = v;
+  }
+
+  int count = 0;
+  int top = 0;
+  dfn[root] = count;
+  vertex[count++] = root;
+  next[root] = offset[root];
+  stack[top++] = root;
+  while (top > 0) {
+    int v = stack[top - 1];
+    if (next[v] < offset[v + 1]) {
+      int w = adj[next[v]++];
+      if (dfn[w] < 0) {
+        dfn[w] = count;
+        vertex[count++] = w;
+        parent[w] = v;
+        next[w] = offset[w];
+        stack[top++] = w;
+      }
+    } else {
+      top--;
+    }
+  }
+  for (int i = 0; i < count; ++i) {
+    semi[vertex[i]] = i;
+  }
+
+  for (int i = count - 1; i > 0; --i) {
+    int w = vertex[i];
+    for (int e = in_offset[w]; e < in_offset[w + 1]; ++e) {
+      int v = in_adj[e];
+      if (dfn[v] < 0) continue;
+      int u = dominator_eval(v, ancestor, label, semi, stack);
+      if (semi[u] < semi[w]) semi[w] = semi[u];
+    }
+    int s = vertex[semi[w]];
+    bucket_next[w] = bucket[s];
+    bucket[s] = w;
+    int p = parent[w];
+    ancestor[w] = p;
+    for (int v = bucket[p]; v >= 0; v = bucket_next[v]) {
+      int u = dominator_eval(v, ancestor, label, semi, stack);
+      idom[v] = semi[u] < semi[v] ? u : p;
+    }
+    bucket[p] = -1;
+  }
+  for (int i = 1; i < count; ++i) {
+    int w = vertex[i];
+    if (idom[w] != vertex[semi[w]]) idom[w] = idom[idom[w]];
+  }
+  idom[root] = root;
+
+  free(dfn);
+  free(vertex);
+  free(parent);
+  free(semi);
+  free(label);
+  free(ancestor);
+  free(bucket);
+  free(bucket_next);
+  free(stack);
+  free(next);
+}
+
+/**
+ * eval of Lengauer-Tarjan: the vertex of minimum semi on the ancestor path of v, compressing the path.
+ * stack is scratch space for the path.
+ */
+static int dominator_eval(int v, int *ancestor, int *label, int *semi, int *stack) {
+  if (ancestor[v] < 0) return v;
+  int top = 0;
+  int x = v;
+  while (ancestor[ancestor[x]] >= 0) {
+    stack[top++] = x;
+    x = ancestor[x];
+  }
+  while (top > 0) {
+    x = stack[--top];
+    if (semi[label[ancestor[x]]] < semi[label[x]]) label[x] = label[ancestor[x]];
+    ancestor[x] = ancestor[ancestor[x]];
+  }
+  return label[v];
+}
+
+/**
+ * mark bridges and non-trivial dominators of a flow graph rooted at 0 where every vertex is reachable.
+ *
+ * @param in_offset   predecessors of the flow graph
+ * @param in_adj
+ * @param in_arc      arc to mark in bridge for every in arc, NULL if it is the in arc itself
+ * @param idom
+ * @param bridge
+ * @param cut
+ */
+static void flow_graph_cuts(int n, int *in_offset, int *in_adj, int *in_arc, int *idom, char *bridge, char *cut) {
+  IntArray edges = {NULL, 0, 0};
+  for (int v = 1; v < n; ++v) {
+    int_array_push(&edges, idom[v]);
+    int_array_push(&edges, v);
+    if (idom[v] != 0) cut[idom[v]] = 1;
+  }
+  // the dominator tree is rooted at 0 as the lowest node
+  LcaForest *tree = create_lca_forest(n, edges.data, edges.size / 2);
+  for (int v = 1; v < n; ++v) {
+    int arc = -1;
+    int only = 1;
+    for (int e = in_offset[v]; e < in_offset[v + 1] && only; ++e) {
+      if (in_adj[e] == idom[v]) {
+        arc = in_arc ? in_arc[e] : e;
+      } else if (!lca_is_ancestor(tree, v, in_adj[e])) {
+        only = 0;
+      }
+    }
+    if (only && arc >= 0) bridge[arc] = 1;
+  }
+  free(edges.data);
+  free_lca_forest(tree);
+}
+
+// amount of vertexes reached from source without passing removed
+static int reach_without(int n, int *offset, int *adj, int source, int removed, char *mark, int *queue) {
+  memset(mark, 0, n);
+  mark[removed] = 1;
+  mark[source] = 1;
+  int head = 0;
+  int tail = 0;
+  queue[tail++] = source;
+  while (head < tail) {
+    int v = queue[head++];
+    for (int e = offset[v]; e < offset[v + 1]; ++e) {
+      if (!mark[adj[e]]) {
+        mark[adj[e]] = 1;
+        queue[tail++] = adj[e];
+      }
+    }
+  }
+  return tail;
+}
+
+// every undirected edge once, from < to by id
+static WeightedArc *collect_weighted_arcs(CSR *csr, int *size) {
+  WeightedArc *arcs = malloc(sizeof(WeightedArc) * (csr->m / 2 + 1));
+  int k = 0;
+  for (int v = 0; v < csr->n; ++v) {
+    for (int e = csr->offset[v]; e < csr->offset[v + 1]; ++e) {
+      int w = csr->adj[e];
+      if (csr->ids[v] < csr->ids[w]) {
+        arcs[k].weight = csr->weight[e];
+        arcs[k].from = v;
+        arcs[k].to = w;
+        k++;
+      }
+    }
+  }
+  *size = k;
+  return arcs;
+}
+
+// stable lsd radix sort by weight, a byte per pass. passes where every weight has the same byte are skipped
+static void radix_sort_arcs(WeightedArc *arcs, WeightedArc *buffer, int size) {
+  WeightedArc *src = arcs;
+  WeightedArc *dst = buffer;
+  for (int shift = 0; shift < 32; shift += 8) {
+    int count[257] = {0};
+    for (int i = 0; i < size; ++i) {
+      count[((((uint32_t) src[i].weight) ^ 0x80000000u) >> shift & 0xff) + 1]++;
+    }
+    if (size == 0 || count[((((uint32_t) src[0].weight) ^ 0x80000000u) >> shift & 0xff) + 1] == size) continue;
+    for (int d = 0; d < 256; ++d) {
+      count[d + 1] += count[d];
+    }
+    for (int i = 0; i < size; ++i) {
+      dst[count[(((uint32_t) src[i].weight) ^ 0x80000000u) >> shift & 0xff]++] = src[i];
+    }
+    WeightedArc *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != arcs) memcpy(arcs, src, sizeof(WeightedArc) * size);
+}
+
+// move arcs lighter than pivot (or equal if inclusive) to the front of [lo, hi), return the end of them
+static int partition_arcs(WeightedArc *arcs, int lo, int hi, int pivot, int inclusive) {
+  int k = lo;
+  for (int i = lo; i < hi; ++i) {
+    if (arcs[i].weight < pivot || (inclusive && arcs[i].weight == pivot)) {
+      WeightedArc t = arcs[k];
+      arcs[k++] = arcs[i];
+      arcs[i] = t;
+    }
+  }
+  return k;
+}
+
+// sort arcs and pass the ones joining two trees to handler
+static void kruskal_arcs(CSR *csr, WeightedArc *arcs, WeightedArc *buffer, int size, DenseUF *uf,
+                         SpanningEdgeHandler handler, void *ctx) {
+  radix_sort_arcs(arcs, buffer, size);
+  for (int i = 0; i < size && uf->count > 1; ++i) {
+    if (dense_uf_union(uf, arcs[i].from, arcs[i].to)) {
+      handler(ctx, csr->ids[arcs[i].from], csr->ids[arcs[i].to], arcs[i].weight);
+    }
+  }
+}
+
+// SpanningEdgeHandler collecting new edges into a LinkedList
+static void append_spanning_edge(void *ctx, int from, int to, int weight) {
+  append_list(ctx, create_edge(from, to, weight));
+}
+
+// every component keeps the lightest arc leaving it, ties broken by arc index so that there is no cycle
+static void boruvka_min_arc(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Boruvka *bv = ctx;
+  while (1) {
+    int start = atomic_fetch_add(&bv->cursor, PAR_GRAIN);
+    if (start >= bv->arc_size) break;
+    int end = start + PAR_GRAIN < bv->arc_size ? start + PAR_GRAIN : bv->arc_size;
+    for (int i = start; i < end; ++i) {
+      int c[2] = {bv->comp[bv->arcs[i].from], bv->comp[bv->arcs[i].to]};
+      if (c[0] == c[1]) continue;
+      uint64_t key = (uint64_t) ((uint32_t) bv->arcs[i].weight ^ 0x80000000u) << 32 | (uint32_t) i;
+      for (int j = 0; j < 2; ++j) {
+        uint64_t best = atomic_load_explicit(&bv->best[c[j]], memory_order_relaxed);
+        while (key < best && !atomic_compare_exchange_weak(&bv->best[c[j]], &best, key));
+      }
+    }
+  }
+}
+
+// hook every component along its lightest arc. of two components choosing the same arc, the lower stays root
+static void boruvka_hook(void *ctx, int tid, int threads) {
+  (void) threads;
+  Boruvka *bv = ctx;
+  while (1) {
+    int start = atomic_fetch_add(&bv->cursor, PAR_GRAIN);
+    if (start >= bv->n) break;
+    int end = start + PAR_GRAIN < bv->n ? start + PAR_GRAIN : bv->n;
+    for (int c = start; c < end; ++c) {
+      if (bv->comp[c] != c) continue;
+      uint64_t best = atomic_load_explicit(&bv->best[c], memory_order_relaxed);
+      if (best == UINT64_MAX) continue;
+      int arc = (int) (best & 0xffffffffu);
+      int other = bv->comp[bv->arcs[arc].from] == c ? bv->comp[bv->arcs[arc].to] : bv->comp[bv->arcs[arc].from];
+      if (c < other && atomic_load_explicit(&bv->best[other], memory_order_relaxed) == best) continue;
+      atomic_store_explicit(&bv->next[c], other, memory_order_relaxed);
+      // arcs move when they are compacted, keep the arc itself
+      int_array_push(&bv->local[tid], bv->arcs[arc].from);
+      int_array_push(&bv->local[tid], bv->arcs[arc].to);
+      int_array_push(&bv->local[tid], bv->arcs[arc].weight);
+      atomic_store_explicit(&bv->hooked, 1, memory_order_relaxed);
+    }
+  }
+}
+
+// point every component at the root of its hooking tree
+static void boruvka_jump(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Boruvka *bv = ctx;
+  while (1) {
+    int start = atomic_fetch_add(&bv->cursor, PAR_GRAIN);
+    if (start >= bv->n) break;
+    int end = start + PAR_GRAIN < bv->n ? start + PAR_GRAIN : bv->n;
+    for (int c = start; c < end; ++c) {
+      if (bv->comp[c] != c) continue;
+      int p = atomic_load_explicit(&bv->next[c], memory_order_relaxed);
+      int pp = atomic_load_explicit(&bv->next[p], memory_order_relaxed);
+      while (p != pp) {
+        atomic_store_explicit(&bv->next[c], pp, memory_order_relaxed);
+        p = pp;
+        pp = atomic_load_explicit(&bv->next[p], memory_order_relaxed);
+      }
+    }
+  }
+}
+
+static void boruvka_relabel(void *ctx, int tid, int threads) {
+  (void) tid;
+  (void) threads;
+  Boruvka *bv = ctx;
+  while (1) {
+    int start = atomic_fetch_add(&bv->cursor, PAR_GRAIN);
+    if (start >= bv->n) break;
+    int end = start + PAR_GRAIN < bv->n ? start + PAR_GRAIN : bv->n;
+    for (int v = start; v < end; ++v) {
+      bv->comp[v] = atomic_load_explicit(&bv->next[bv->comp[v]], memory_order_relaxed);
+      atomic_store_explicit(&bv->best[v], UINT64_MAX, memory_order_relaxed);
+    }
+  }
+}
+
+// insert v with key, or decrease the key of v already in heap
+static void indexed_heap_update(IndexedHeap *heap, int v, int key) {
+  int i = heap->pos[v];
+  if (i < 0) i = heap->size++;
+  heap->key[v] = key;
+  while (i > 0 && heap->key[heap->heap[(i - 1) / 2]] > key) {
+    heap->heap[i] = heap->heap[(i - 1) / 2];
+    heap->pos[heap->heap[i]] = i;
+    i = (i - 1) / 2;
+  }
+  heap->heap[i] = v;
+  heap->pos[v] = i;
+}
+
+static int indexed_heap_pop(IndexedHeap *heap) {
+  int top = heap->heap[0];
+  heap->pos[top] = -1;
+  int last = heap->heap[--heap->size];
+  if (heap->size == 0) return top;
+  int key = heap->key[last];
+  int i = 0;
+  while (1) {
+    int child = 2 * i + 1;
+    if (child >= heap->size) break;
+    if (child + 1 < heap->size && heap->key[heap->heap[child + 1]] < heap->key[heap->heap[child]]) child++;
+    if (heap->key[heap->heap[child]] >= key) break;
+    heap->heap[i] = heap->heap[child];
+    heap->pos[heap->heap[i]] = i;
+    i = child;
+  }
+  heap->heap[i] = last;
+  heap->pos[last] = i;
+  return top;
+}
+
+static IncrementalMsf *create_incremental_msf(Graph *graph) {
+  IncrementalMsf *msf = calloc(1, sizeof(IncrementalMsf));
+  if (!msf) return NULL;
+  msf->index = new_hash_table(int_hash, int_compare);
+  // key is inside the slot
+  register_hashtable_free_functions(msf->index, NULL, free);
+  HashtableIterator *iter = hashtable_iterator(graph->represent);
+  while (hashtable_iter_has_next(iter)) {
+    msf_add_vertex(msf, *(int *) table_entry_key(hashtable_next_entry(iter)));
+  }
+  free_hashtable_iter(iter);
+  iter = hashtable_iterator(graph->edges);
+  while (hashtable_iter_has_next(iter)) {
+    HashsetIterator *iterator = hashset_iterator(table_entry_value(hashtable_next_entry(iter)));
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      // every undirected edge is stored in both directions
+      if (edge->from < edge->to) {
+        msf_insert_edge(msf, edge->from, edge->to, edge->weight);
+      }
+    }
+    free_hashset_iter(iterator);
+  }
+  free_hashtable_iter(iter);
+  return msf;
+}
+
+// the forest of graph, rebuilt if it is stale
+static IncrementalMsf *fresh_msf(Graph *graph) {
+  if (graph->msf->stale) {
+    free_incremental_msf(graph->msf);
+    graph->msf = create_incremental_msf(graph);
+  }
+  return graph->msf;
+}
+
+static void free_incremental_msf(IncrementalMsf *msf) {
+  if (!msf) return;
+  free_hash_table(msf->index);
+  free(msf->nodes);
+  free(msf->ids);
+  free(msf->free_nodes.data);
+  free(msf->path.data);
+  free(msf);
+}
+
+static void msf_add_vertex(IncrementalMsf *msf, int id) {
+  IdSlot *slot = malloc(sizeof(IdSlot));
+  slot->id = id;
+  slot->idx = lct_new_node(msf, INT_MIN, -1, -1);
+  msf->ids[slot->idx] = id;
+  put_hash_table(msf->index, &slot->id, slot);
+  msf->vertex_count++;
+}
+
+/**
+ * add edge to the forest if it joins two trees, or if it is lighter than the heaviest edge on the path
+ * between its ends, which is then replaced.
+ */
+static void msf_insert_edge(IncrementalMsf *msf, int from, int to, int weight) {
+  int u = ((IdSlot *) get_hash_table(msf->index, &from))->idx;
+  int v = ((IdSlot *) get_hash_table(msf->index, &to))->idx;
+  if (lct_find_root(msf, u) == lct_find_root(msf, v)) {
+    lct_make_root(msf, u);
+    lct_access(msf, v);
+    int heaviest = msf->nodes[v].max;
+    if (msf->nodes[heaviest].weight <= weight) return;
+    LctNode *node = &msf->nodes[heaviest];
+    int a = node->from;
+    int b = node->to;
+    msf->weight -= node->weight;
+    msf->tree_edges--;
+    lct_cut(msf, heaviest, a);
+    lct_cut(msf, heaviest, b);
+    msf->nodes[heaviest].from = -1;
+    msf->nodes[heaviest].to = -1;
+    int_array_push(&msf->free_nodes, heaviest);
+  }
+  int e = lct_new_node(msf, weight, u, v);
+  lct_link(msf, u, e);
+  lct_link(msf, e, v);
+  msf->weight += weight;
+  msf->tree_edges++;
+}
+
+// a node with no children, edge nodes are reused from the free list
+static int lct_new_node(IncrementalMsf *msf, int weight, int from, int to) {
+  int x;
+  if (from >= 0 && msf->free_nodes.size > 0) {
+    x = msf->free_nodes.data[--msf->free_nodes.size];
+  } else {
+    if (msf->size == msf->capacity) {
+      msf->capacity = msf->capacity ? msf->capacity * 2 : 64;
+      msf->nodes = realloc(msf->nodes, sizeof(LctNode) * msf->capacity);
+      msf->ids = realloc(msf->ids, sizeof(int) * msf->capacity);
+    }
+    x = msf->size++;
+  }
+  LctNode *node = &msf->nodes[x];
+  node->child[0] = node->child[1] = -1;
+  node->parent = -1;
+  node->flip = 0;
+  node->weight = weight;
+  node->max = x;
+  node->from = from;
+  node->to = to;
+  return x;
+}
+
+// x is the root of its splay tree
+static int lct_is_root(LctNode *nodes, int x) {
+  int p = nodes[x].parent;
+  return p < 0 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+}
+
+static void lct_update(LctNode *nodes, int x) {
+  nodes[x].max = x;
+  for (int i = 0; i < 2; ++i) {
+    int c = nodes[x].child[i];
+    if (c >= 0 && nodes[nodes[c].max].weight > nodes[nodes[x].max].weight) {
+      nodes[x].max = nodes[c].max;
+    }
+  }
+}
+
+static void lct_push(LctNode *nodes, int x) {
+  if (!nodes[x].flip) return;
+  int t = nodes[x].child[0];
+  nodes[x].child[0] = nodes[x].child[1];
+  nodes[x].child[1] = t;
+  for (int i = 0; i < 2; ++i) {
+    if (nodes[x].child[i] >= 0) nodes[nodes[x].child[i]].flip ^= 1;
+  }
+  nodes[x].flip = 0;
+}
+
+static void lct_rotate(LctNode *nodes, int x) {
+  int y = nodes[x].parent;
+  int z = nodes[y].parent;
+  int dx = nodes[y].child[1] == x;
+  if (!lct_is_root(nodes, y)) {
+    nodes[z].child[nodes[z].child[1] == y] = x;
+  }
+  nodes[x].parent = z;
+  int b = nodes[x].child[!dx];
+  nodes[y].child[dx] = b;
+  if (b >= 0) nodes[b].parent = y;
+  nodes[x].child[!dx] = y;
+  nodes[y].parent = x;
+  lct_update(nodes, y);
+  lct_update(nodes, x);
+}
+
+static void lct_splay(IncrementalMsf *msf, int x) {
+  LctNode *nodes = msf->nodes;
+  // push flips down from the root of the splay tree
+  msf->path.size = 0;
+  int_array_push(&msf->path, x);
+  for (int y = x; !lct_is_root(nodes, y); y = nodes[y].parent) {
+    int_array_push(&msf->path, nodes[y].parent);
+  }
+  for (int i = msf->path.size - 1; i >= 0; --i) {
+    lct_push(nodes, msf->path.data[i]);
+  }
+  while (!lct_is_root(nodes, x)) {
+    int y = nodes[x].parent;
+    if (!lct_is_root(nodes, y)) {
+      int z = nodes[y].parent;
+      lct_rotate(nodes, (nodes[y].child[0] == x) == (nodes[z].child[0] == y) ? y : x);
+    }
+    lct_rotate(nodes, x);
+  }
+}
+
+// make the path from the root of its tree to x preferred, x ends up as the root of its splay tree
+static void lct_access(IncrementalMsf *msf, int x) {
+  int last = -1;
+  for (int y = x; y >= 0; y = msf->nodes[y].parent) {
+    lct_splay(msf, y);
+    msf->nodes[y].child[1] = last;
+    lct_update(msf->nodes, y);
+    last = y;
+  }
+  lct_splay(msf, x);
+}
+
+static void lct_make_root(IncrementalMsf *msf, int x) {
+  lct_access(msf, x);
+  msf->nodes[x].flip ^= 1;
+}
+
+static int lct_find_root(IncrementalMsf *msf, int x) {
+  lct_access(msf, x);
+  while (1) {
+    lct_push(msf->nodes, x);
+    if (msf->nodes[x].child[0] < 0) break;
+    x = msf->nodes[x].child[0];
+  }
+  lct_splay(msf, x);
+  return x;
+}
+
+// x and y are in different trees
+static void lct_link(IncrementalMsf *msf, int x, int y) {
+  lct_make_root(msf, x);
+  msf->nodes[x].parent = y;
+}
+
+// x and y are adjacent
+static void lct_cut(IncrementalMsf *msf, int x, int y) {
+  lct_make_root(msf, x);
+  lct_access(msf, y);
+  msf->nodes[y].child[0] = -1;
+  msf->nodes[x].parent = -1;
+  lct_update(msf->nodes, y);
+}
+
+static FlowNetwork *create_flow_network(Graph *graph) {
+  FlowNetwork *network = malloc(sizeof(FlowNetwork));
+  CSR *csr = create_csr(graph);
+  int n = csr->n;
+  int m = csr->m;
+  int v, k;
+  network->csr = csr;
+  network->n = n;
+  network->offset = calloc(n + 1, sizeof(int));
+  network->arc = malloc(sizeof(int) * (2 * m + 1));
+  network->head = malloc(sizeof(int) * (2 * m + 1));
+  network->cap = malloc(sizeof(int) * (2 * m + 1));
+  for (v = 0; v < n; ++v) {
+    for (k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      network->offset[v + 1]++;
+      network->offset[csr->adj[k] + 1]++;
+      network->head[2 * k] = csr->adj[k];
+      network->cap[2 * k] = csr->weight[k];
+      network->head[2 * k + 1] = v;
+      network->cap[2 * k + 1] = 0;
+    }
+  }
+  for (v = 0; v < n; ++v) network->offset[v + 1] += network->offset[v];
+  int *fill = malloc(sizeof(int) * (n + 1));
+  memcpy(fill, network->offset, sizeof(int) * (n + 1));
+  for (v = 0; v < n; ++v) {
+    for (k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      network->arc[fill[v]++] = 2 * k;
+      network->arc[fill[csr->adj[k]]++] = 2 * k + 1;
+    }
+  }
+  free(fill);
+  return network;
+}
+
+static void free_flow_network(FlowNetwork *network) {
+  free_csr(network->csr);
+  free(network->offset);
+  free(network->arc);
+  free(network->head);
+  free(network->cap);
+  free(network);
+}
+
+// same format as copy_edges, with the weight of each edge set to its flow
+static Hashtable *flow_network_map(FlowNetwork *network) {
+  CSR *csr = network->csr;
+  Hashtable *flow = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(flow, free, NULL);
+  for (int v = 0; v < csr->n; ++v) {
+    if (csr->offset[v] == csr->offset[v + 1]) continue;
+    Hashset *edges = new_hash_set(default_edge_hash_func, default_edge_equal_func);
+    register_hashset_free_functions(edges, free);
+    for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      put_hash_set(edges, create_edge(csr->ids[v], csr->ids[csr->adj[k]], network->cap[2 * k + 1]));
+    }
+    put_hash_table(flow, new_id(csr->ids[v]), edges);
+  }
+  return flow;
+}
+
+// max flow from s to t. level is left by the last bfs, vertexes on the source side of the minimum cut are the
+// ones with level >= 0
+static int dinic(FlowNetwork *network, int s, int t, int *level) {
+  int n = network->n;
+  int *queue = malloc(sizeof(int) * n);
+  int *current = malloc(sizeof(int) * n);
+  int *stack = malloc(sizeof(int) * n);
+  int flow = 0;
+  while (dinic_level(network, s, t, level, queue)) {
+    memcpy(current, network->offset, sizeof(int) * n);
+    flow += dinic_blocking_flow(network, s, t, level, current, stack);
+  }
+  free(queue);
+  free(current);
+  free(stack);
+  return flow;
+}
+
+// bfs level graph over arcs with residual capacity, return 1 if t is reachable
+static int dinic_level(FlowNetwork *network, int s, int t, int *level, int *queue) {
+  for (int i = 0; i < network->n; ++i) level[i] = -1;
+  int front = 0, rear = 0;
+  level[s] = 0;
+  queue[rear++] = s;
+  while (front < rear) {
+    int v = queue[front++];
+    for (int i = network->offset[v]; i < network->offset[v + 1]; ++i) {
+      int e = network->arc[i];
+      int w = network->head[e];
+      if (network->cap[e] > 0 && level[w] < 0) {
+        level[w] = level[v] + 1;
+        queue[rear++] = w;
+      }
+    }
+  }
+  return level[t] >= 0;
+}
+
+// augment along level graph paths until t is cut off. stack keeps the arcs of the current path from s, and
+// current[v] is the next arc of v to try: an arc is skipped only when it is saturated or leads to a dead end,
+// so every arc is passed at most once per phase.
+static int dinic_blocking_flow(FlowNetwork *network, int s, int t, int *level, int *current, int *stack) {
+  int *arc = network->arc;
+  int *head = network->head;
+  int *cap = network->cap;
+  int total = 0;
+  int top = 0;
+  int v = s;
+  while (1) {
+    if (v == t) {
+      int f = INT_MAX;
+      int i;
+      for (i = 0; i < top; ++i) {
+        if (cap[stack[i]] < f) f = cap[stack[i]];
+      }
+      total += f;
+      // retreat to the tail of the first saturated arc
+      int cut = -1;
+      for (i = 0; i < top; ++i) {
+        cap[stack[i]] -= f;
+        cap[stack[i] ^ 1] += f;
+        if (cut < 0 && cap[stack[i]] == 0) cut = i;
+      }
+      top = cut;
+      v = head[stack[top] ^ 1];
+      continue;
+    }
+    int end = network->offset[v + 1];
+    while (current[v] < end) {
+      int e = arc[current[v]];
+      if (cap[e] > 0 && level[head[e]] == level[v] + 1) break;
+      current[v]++;
+    }
+    if (current[v] < end) {
+      int e = arc[current[v]];
+      stack[top++] = e;
+      v = head[e];
+      continue;
+    }
+    // dead end, no path to t goes through v in this phase
+    level[v] = -1;
+    if (v == s) break;
+    v = head[stack[--top] ^ 1];
+    current[v]++;
+  }
+  return total;
+}
+
+// exact heights by backward bfs from root over arcs with residual capacity, root and fixed keep their heights.
+// vertexes that can not reach root are put n above root.
+static void push_relabel_global(PushRelabel *pr, int root, int fixed) {
+  FlowNetwork *network = pr->network;
+  int n = network->n;
+  int *queue = pr->current;
+  int v;
+  for (v = 0; v < n; ++v) {
+    if (v != root && v != fixed) pr->height[v] = -1;
+  }
+  int front = 0, rear = 0;
+  queue[rear++] = root;
+  while (front < rear) {
+    v = queue[front++];
+    for (int i = network->offset[v]; i < network->offset[v + 1]; ++i) {
+      int e = network->arc[i];
+      int w = network->head[e];
+      if (pr->height[w] < 0 && network->cap[e ^ 1] > 0) {
+        pr->height[w] = pr->height[v] + 1;
+        queue[rear++] = w;
+      }
+    }
+  }
+  memset(pr->count, 0, sizeof(int) * n);
+  for (v = 0; v < n; ++v) {
+    if (pr->height[v] < 0) pr->height[v] = pr->height[root] + n;
+    if (pr->height[v] < n) pr->count[pr->height[v]]++;
+  }
+  memcpy(pr->current, network->offset, sizeof(int) * n);
+  pr->relabels = 0;
+}
+
+static void push_relabel_enqueue(PushRelabel *pr, int v) {
+  if (pr->active[v] || pr->excess[v] <= 0 || v == pr->s || v == pr->t) return;
+  int n = pr->network->n;
+  pr->queue[(pr->head + pr->size) % n] = v;
+  pr->size++;
+  pr->active[v] = 1;
+}
+
+// push the excess of v along admissible arcs, relabel v when they run out. with gap, v stops once it is
+// lifted to n, and a relabel that empties a height below n lifts every vertex above it to n.
+static void push_relabel_discharge(PushRelabel *pr, int v, int gap) {
+  FlowNetwork *network = pr->network;
+  int n = network->n;
+  int *height = pr->height;
+  int end = network->offset[v + 1];
+  while (pr->excess[v] > 0) {
+    if (pr->current[v] == end) {
+      int old = height[v];
+      int h = INT_MAX;
+      for (int i = network->offset[v]; i < end; ++i) {
+        int e = network->arc[i];
+        if (network->cap[e] > 0 && height[network->head[e]] + 1 < h) h = height[network->head[e]] + 1;
+      }
+      pr->current[v] = network->offset[v];
+      pr->relabels++;
+      if (!gap) {
+        height[v] = h;
+        continue;
+      }
+      if (old < n && --pr->count[old] == 0) {
+        for (int u = 0; u < n; ++u) {
+          if (height[u] > old && height[u] < n && u != pr->s) {
+            pr->count[height[u]]--;
+            height[u] = n;
+          }
+        }
+        h = n;
+      }
+      height[v] = h < n ? h : n;
+      if (height[v] == n) return;
+      pr->count[h]++;
+      continue;
+    }
+    int e = network->arc[pr->current[v]];
+    int w = network->head[e];
+    if (network->cap[e] > 0 && height[v] == height[w] + 1) {
+      int f = pr->excess[v] < network->cap[e] ? (int) pr->excess[v] : network->cap[e];
+      network->cap[e] -= f;
+      network->cap[e ^ 1] += f;
+      pr->excess[v] -= f;
+      pr->excess[w] += f;
+      push_relabel_enqueue(pr, w);
+      if (network->cap[e] == 0) pr->current[v]++;
+    } else {
+      pr->current[v]++;
+    }
+  }
+}
+
+// cut of undirected graph between the slots with side set and the rest
+static StCut *global_cut(CSR *csr, char *side, int value) {
+  int n = csr->n;
+  StCut *cut = malloc(sizeof(StCut));
+  cut->value = value;
+  cut->size = n;
+  cut->id_list = malloc(sizeof(int) * n);
+  memcpy(cut->id_list, csr->ids, sizeof(int) * n);
+  cut->side = calloc((n + 63) / 64, sizeof(uint64_t));
+  IntArray edges = {NULL, 0, 0};
+  for (int v = 0; v < n; ++v) {
+    if (!side[v]) continue;
+    cut->side[v >> 6] |= 1ULL << (v & 63);
+    for (int k = csr->offset[v]; k < csr->offset[v + 1]; ++k) {
+      if (side[csr->adj[k]]) continue;
+      int_array_push(&edges, csr->ids[v]);
+      int_array_push(&edges, csr->ids[csr->adj[k]]);
+    }
+  }
+  cut->cut_edges = edges.data;
+  cut->cut_edge_size = edges.size / 2;
+  return cut;
+}
+
+static void karger_stein_trials(void *ctx, int tid, int threads) {
+  (void) threads;
+  KargerStein *ks = ctx;
+  KsLevel top = {.arcs=ks->arcs, .size=ks->arc_size, .k=ks->n, .relabel=NULL, .up=NULL};
+  char *buffer = malloc(ks->n);
+  while (1) {
+    int i = atomic_fetch_add(&ks->cursor, 1);
+    if (i >= ks->trials) break;
+    KsTrial trial = {.n=ks->n, .rng=ks->seed + (unsigned int) i * 2654435761u, .best=ks->best[tid],
+        .side=ks->side[tid], .buffer=buffer};
+    karger_stein_recurse(&trial, &top);
+    if (trial.best < ks->best[tid]) {
+      ks->best[tid] = trial.best;
+      ks->best_trial[tid] = i;
+    }
+  }
+  free(buffer);
+}
+
+// contract to about k / sqrt(2) vertexes twice independently and recurse on both, the minimum cut survives
+// a contraction with probability about 1/2
+static void karger_stein_recurse(KsTrial *trial, KsLevel *level) {
+  if (level->k <= KARGER_STEIN_BASE) {
+    karger_stein_base(trial, level);
+    return;
+  }
+  int target = 1 + (level->k * 181 + 255) / 256;
+  for (int round = 0; round < 2; ++round) {
+    KsLevel contracted;
+    karger_stein_contract(trial, level, target, &contracted);
+    karger_stein_recurse(trial, &contracted);
+    free(contracted.arcs);
+    free(contracted.relabel);
+  }
+}
+
+// contract random edges, each picked with probability proportional to its weight, until target vertexes are
+// left. edges inside a contracted vertex are rejected, and dropped once they outnumber the picks.
+// relabel the vertexes to 0 ... target-1 and keep the edges between them.
+static void karger_stein_contract(KsTrial *trial, KsLevel *level, int target, KsLevel *contracted) {
+  WeightedArc *arcs = level->arcs;
+  int size = level->size;
+  int k = level->k;
+  DenseUF uf = {NULL, NULL, 0, 0, 0};
+  int i, v;
+  for (v = 0; v < k; ++v) dense_uf_add(&uf);
+  WeightedArc *live = malloc(sizeof(WeightedArc) * (size + 1));
+  memcpy(live, arcs, sizeof(WeightedArc) * size);
+  int64_t *prefix = malloc(sizeof(int64_t) * (size + 1));
+  int live_size = size;
+  int rejects = size; // prefix sums are built before the first pick
+  while (uf.count > target) {
+    if (rejects >= live_size) {
+      int kept = 0;
+      prefix[0] = 0;
+      for (i = 0; i < live_size; ++i) {
+        if (dense_uf_find(&uf, live[i].from) == dense_uf_find(&uf, live[i].to)) continue;
+        live[kept] = live[i];
+        prefix[kept + 1] = prefix[kept] + live[i].weight;
+        kept++;
+      }
+      live_size = kept;
+      rejects = 0;
+      if (live_size == 0) break;
+    }
+    uint64_t r = (uint64_t) rand_r(&trial->rng) << 31 | (uint64_t) rand_r(&trial->rng);
+    int64_t pick = (int64_t) (r % (uint64_t) prefix[live_size]);
+    // first edge whose prefix passes pick
+    int lo = 0, hi = live_size - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (prefix[mid + 1] > pick) hi = mid;
+      else lo = mid + 1;
+    }
+    if (!dense_uf_union(&uf, live[lo].from, live[lo].to)) rejects++;
+  }
+  int *relabel = malloc(sizeof(int) * k);
+  int c = 0;
+  for (v = 0; v < k; ++v) {
+    if (dense_uf_find(&uf, v) == v) relabel[v] = c++;
+  }
+  for (v = 0; v < k; ++v) relabel[v] = relabel[dense_uf_find(&uf, v)];
+  // bucket the edges by their lower end and merge parallel ones, so that no more than target^2 / 2 are left
+  int *start = calloc(c + 1, sizeof(int));
+  int *merged = malloc(sizeof(int) * c); // <higher end, index of the merged edge> in the current bucket
+  for (i = 0; i < size; ++i) {
+    int from = relabel[arcs[i].from];
+    int to = relabel[arcs[i].to];
+    if (from != to) start[(from < to ? from : to) + 1]++;
+  }
+  for (v = 0; v < c; ++v) {
+    start[v + 1] += start[v];
+    merged[v] = -1;
+  }
+  for (i = 0; i < size; ++i) {
+    int from = relabel[arcs[i].from];
+    int to = relabel[arcs[i].to];
+    if (from == to) continue;
+    WeightedArc *arc = &live[start[from < to ? from : to]++];
+    arc->weight = arcs[i].weight;
+    arc->from = from < to ? from : to;
+    arc->to = from < to ? to : from;
+  }
+  int kept = 0;
+  for (v = 0, i = 0; v < c; ++v) {
+    int bucket = kept;
+    for (; i < start[v]; ++i) {
+      if (merged[live[i].to] >= bucket) {
+        live[merged[live[i].to]].weight += live[i].weight;
+      } else {
+        merged[live[i].to] = kept;
+        live[kept++] = live[i];
+      }
+    }
+  }
+  contracted->arcs = live;
+  contracted->size = kept;
+  contracted->k = c;
+  contracted->relabel = relabel;
+  contracted->up = level;
+  free(start);
+  free(merged);
+  free(prefix);
+  dense_uf_free(&uf);
+}
+
+// stoer-wagner on the adjacency matrix of a small contracted graph, merged vertexes are masks of the level
+static void karger_stein_base(KsTrial *trial, KsLevel *level) {
+  int k = level->k;
+  int w[KARGER_STEIN_BASE][KARGER_STEIN_BASE] = {{0}};
+  int key[KARGER_STEIN_BASE];
+  uint32_t members[KARGER_STEIN_BASE];
+  char merged[KARGER_STEIN_BASE] = {0};
+  char added[KARGER_STEIN_BASE];
+  int i, v;
+  for (i = 0; i < level->size; ++i) {
+    w[level->arcs[i].from][level->arcs[i].to] += level->arcs[i].weight;
+    w[level->arcs[i].to][level->arcs[i].from] += level->arcs[i].weight;
+  }
+  for (v = 0; v < k; ++v) members[v] = 1u << v;
+  for (int phase = k; phase > 1; --phase) {
+    int s = -1, t = -1;
+    for (v = 0; v < k; ++v) {
+      key[v] = 0;
+      added[v] = merged[v];
+    }
+    for (i = 0; i < phase; ++i) {
+      int u = -1;
+      for (v = 0; v < k; ++v) {
+        if (!added[v] && (u < 0 || key[v] > key[u])) u = v;
+      }
+      added[u] = 1;
+      s = t;
+      t = u;
+      for (v = 0; v < k; ++v) {
+        if (!added[v]) key[v] += w[u][v];
+      }
+    }
+    if (key[t] < trial->best) {
+      trial->best = key[t];
+      // lift the side level by level up to the slots
+      char *side = trial->buffer;
+      char *upper = trial->side;
+      for (v = 0; v < k; ++v) side[v] = (char) (members[t] >> v & 1);
+      for (KsLevel *l = level; l->relabel; l = l->up) {
+        for (v = 0; v < l->up->k; ++v) upper[v] = side[l->relabel[v]];
+        char *tmp = side;
+        side = upper;
+        upper = tmp;
+      }
+      if (side != trial->side) memcpy(trial->side, side, trial->n);
+    }
+    for (v = 0; v < k; ++v) {
+      w[s][v] += w[t][v];
+      w[v][s] = w[s][v];
+    }
+    w[s][s] = 0;
+    members[s] |= members[t];
+    merged[t] = 1;
+  }
+}
 //--------------- static functions ----------------------
\ No newline at end of file
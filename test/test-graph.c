@@ -6,9 +6,12 @@
 #include <assert.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
 
 #include "help_test/framework.h"
 #include "zgraph.h"
+#include "hashtable/hash-int.h"
+#include "hashtable/compare-int.h"
 
 Graph *create_test_graph(int size, int directed, int weighted) {
   Graph *graph = create_graph(directed, weighted);
@@ -2002,6 +2005,1461 @@ void test_hungarian(){
   fflush(stdout);
 }
 
+Graph *create_random_graph(int size, int edges, int directed, int weighted, unsigned int seed) {
+  Graph *graph = create_graph(directed, weighted);
+  for (int i = 0; i < size; ++i) {
+    int id = add_graph_data(graph, NULL);
+    assert(id == i);
+  }
+  srand(seed);
+  for (int i = 0; i < edges; ++i) {
+    int from = rand() % size;
+    int to = rand() % size;
+    if (from == to) continue;
+    add_edge(graph, from, to, weighted ? rand() % 100 + 1 : 0);
+  }
+  return graph;
+}
+
+static int path_depth(Hashtable *pre_map, int id) {
+  int depth = 0;
+  int *p = get_hash_table(pre_map, &id);
+  while (*p != id) {
+    id = *p;
+    p = get_hash_table(pre_map, &id);
+    depth++;
+  }
+  return depth;
+}
+
+void test_direction_optimizing_bfs() {
+  for (int directed = 0; directed <= 1; ++directed) {
+    int size = 2000;
+    Graph *graph = create_random_graph(size, size * 8, directed, 0, 26);
+    Hashtable *expect = single_source_path(graph, 0, BFS);
+    Hashtable *pre_map = direction_optimizing_bfs(graph, 0);
+    assert(pre_map != NULL);
+    assert(size_of_hash_table(pre_map) == size_of_hash_table(expect));
+    HashtableIterator *iter = hashtable_iterator(expect);
+    while (hashtable_iter_has_next(iter)) {
+      int *id = table_entry_key(hashtable_next_entry(iter));
+      assert(contains_in_hash_table(pre_map, id));
+      assert(path_depth(pre_map, *id) == path_depth(expect, *id));
+    }
+    free_hashtable_iter(iter);
+    free_hash_table(expect);
+    free_hash_table(pre_map);
+    free_graph(graph);
+  }
+
+  Graph *graph = create_test_graph_unconnected(10, 0, 0);
+  Hashtable *pre_map = direction_optimizing_bfs(graph, 4);
+  assert(size_of_hash_table(pre_map) == 2);
+  assert(*(int *) get_hash_table(pre_map, &(int) {5}) == 4);
+  free_hash_table(pre_map);
+  assert(direction_optimizing_bfs(graph, 100) == NULL);
+  free_graph(graph);
+}
+
+void test_bfs_par() {
+  int size = 5000;
+  Graph *graph = create_random_graph(size, size * 8, 0, 0, 27);
+  VertexEntry *v = bfs_graph_par(graph, 4);
+  assert(v->size == size);
+  Hashset *seen = new_hash_set(int_hash, int_compare);
+  for (int i = 0; i < v->size; ++i) {
+    assert(has_vertex(graph, v->id_list[i]) == 1);
+    assert(!contains_in_hash_set(seen, &v->id_list[i]));
+    put_hash_set(seen, &v->id_list[i]);
+  }
+  free_hash_set(seen);
+
+  // vertexes of the first component come in level order
+  Hashtable *pre_map = single_source_path(graph, v->id_list[0], BFS);
+  int last_depth = 0;
+  for (int i = 0; i < size_of_hash_table(pre_map); ++i) {
+    int depth = path_depth(pre_map, v->id_list[i]);
+    assert(depth == last_depth || depth == last_depth + 1);
+    last_depth = depth;
+  }
+  free_hash_table(pre_map);
+  free_vertex_entry(v);
+  free_graph(graph);
+
+  graph = create_test_graph_unconnected(100, 1, 0);
+  v = bfs_graph_par(graph, 0);
+  assert(v->size == 100);
+  free_vertex_entry(v);
+  free_graph(graph);
+}
+
+void test_multi_source_bfs() {
+  int size = 500;
+  Graph *graph = create_random_graph(size, size * 2, 1, 0, 28);
+  // one batch, then more than the 256 sources of one batch
+  int sizes[] = {70, 300};
+  int sources[300];
+  for (int k = 0; k < 2; ++k) {
+    int source_size = sizes[k];
+    for (int i = 0; i < source_size; ++i) {
+      sources[i] = (i * 7) % size;
+    }
+    HopMatrix *matrix = multi_source_bfs(graph, sources, source_size);
+    assert(matrix != NULL);
+    assert(matrix->size == size);
+    assert(matrix->source_size == source_size);
+    for (int i = 0; i < source_size; ++i) {
+      assert(matrix->source_list[i] == sources[i]);
+      Hashtable *pre_map = single_source_path(graph, sources[i], BFS);
+      for (int j = 0; j < matrix->size; ++j) {
+        int id = matrix->id_list[j];
+        int hops = matrix->hops[i * matrix->size + j];
+        if (contains_in_hash_table(pre_map, &id)) {
+          assert(hops == path_depth(pre_map, id));
+        } else {
+          assert(hops == -1);
+        }
+      }
+      free_hash_table(pre_map);
+    }
+    free_hop_matrix(matrix);
+  }
+
+  sources[0] = size;
+  assert(multi_source_bfs(graph, sources, 1) == NULL);
+  free_graph(graph);
+}
+
+void test_dfs_long_chain() {
+  // deep enough to overflow the stack of a recursive dfs
+  int size = 100000;
+  for (int directed = 0; directed <= 1; ++directed) {
+    Graph *graph = create_graph(directed, 0);
+    for (int i = 0; i < size; ++i) {
+      add_graph_data(graph, NULL);
+    }
+    for (int i = 0; i < size - 1; ++i) {
+      add_edge(graph, i, i + 1, 0);
+    }
+    VertexEntry *v = dfs_graph(graph);
+    assert(v->size == size);
+    free_vertex_entry(v);
+    assert(has_path(graph, 0, size - 1));
+    assert(!has_circle(graph));
+    Hashtable *pre_map = single_source_path(graph, 0, DFS);
+    assert(path_depth(pre_map, size - 1) == size - 1);
+    free_hash_table(pre_map);
+    if (!directed) {
+      assert(component_count(graph) == 1);
+      assert(is_bipartite(graph));
+      LinkedList *bridges = find_bridge(graph);
+      assert(list_size(bridges) == size - 1);
+      free_linked_list(bridges, NULL);
+      LinkedList *cut_points = find_cut_point(graph);
+      assert(list_size(cut_points) == size - 2);
+      free_linked_list(cut_points, free);
+    }
+    add_edge(graph, size - 1, 0, 0);
+    assert(has_circle(graph));
+    free_graph(graph);
+  }
+}
+
+typedef struct VisitCount {
+  int target;
+  int discovered;
+  int finished;
+  int edges;
+  int last_depth;
+  Hashtable *depth;
+  int stopped; // set when discover returns VISIT_STOP, no callback may come after it
+  int order[512]; // discovered vertexes in order
+} VisitCount;
+
+static VisitResult count_discover(void *ctx, int id, int pid) {
+  VisitCount *count = ctx;
+  assert(!count->stopped && count->discovered < 512);
+  count->order[count->discovered++] = id;
+  if (count->depth) {
+    int d = id == pid ? 0 : *(int *) get_hash_table(count->depth, &pid) + 1;
+    assert(d >= count->last_depth);
+    count->last_depth = d;
+    put_hash_table(count->depth, new_id(id), new_id(d));
+  }
+  if (id != count->target) return VISIT_CONTINUE;
+  count->stopped = 1;
+  return VISIT_STOP;
+}
+
+static VisitResult count_finish(void *ctx, int id, int pid) {
+  (void) id;
+  (void) pid;
+  VisitCount *count = ctx;
+  assert(!count->stopped);
+  count->finished++;
+  return VISIT_CONTINUE;
+}
+
+// do not expand vertex 1
+static VisitResult skip_discover(void *ctx, int id, int pid) {
+  count_discover(ctx, id, pid);
+  return id == 1 ? VISIT_SKIP : VISIT_CONTINUE;
+}
+
+static VisitResult count_edge(void *ctx, Edge *edge) {
+  VisitCount *count = ctx;
+  count->edges++;
+  // never go through vertex 1
+  return get_edge_to(edge) == 1 ? VISIT_SKIP : VISIT_CONTINUE;
+}
+
+void test_graph_visit() {
+  Graph *graph = create_random_graph(300, 900, 1, 0, 30);
+  Hashtable *pre_map = single_source_path(graph, 0, DFS);
+  int reachable = size_of_hash_table(pre_map);
+  free_hash_table(pre_map);
+
+  VisitCount count = {.target=-1};
+  GraphVisitor visitor = {.discover=count_discover, .finish=count_finish, .ctx=&count};
+  assert(graph_dfs_visit(graph, 0, &visitor) == VISIT_CONTINUE);
+  assert(count.discovered == reachable);
+  assert(count.finished == reachable);
+
+  memset(&count, 0, sizeof(VisitCount));
+  count.target = -1;
+  count.depth = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(count.depth, free, free);
+  assert(graph_bfs_visit(graph, 0, &visitor) == VISIT_CONTINUE);
+  assert(count.discovered == reachable);
+  assert(count.finished == reachable);
+  free_hash_table(count.depth);
+  count.depth = NULL;
+
+  // stop half way: the search is the full one cut right after the target is discovered
+  VisitCount full;
+  for (int bfs = 0; bfs <= 1; ++bfs) {
+    memset(&full, 0, sizeof(VisitCount));
+    full.target = -1;
+    visitor.ctx = &full;
+    assert((bfs ? graph_bfs_visit(graph, 0, &visitor) : graph_dfs_visit(graph, 0, &visitor)) == VISIT_CONTINUE);
+    visitor.ctx = &count;
+    int at = reachable / 2;
+    memset(&count, 0, sizeof(VisitCount));
+    count.target = full.order[at];
+    int ret = bfs ? graph_bfs_visit(graph, 0, &visitor) : graph_dfs_visit(graph, 0, &visitor);
+    assert(ret == VISIT_STOP);
+    assert(count.discovered == at + 1);
+    assert(count.order[count.discovered - 1] == count.target);
+    assert(memcmp(count.order, full.order, sizeof(int) * (at + 1)) == 0);
+    assert(count.finished < full.finished);
+  }
+
+  // skip every edge to vertex 1
+  Graph *chain = create_graph(0, 0);
+  for (int i = 0; i < 5; ++i) {
+    add_graph_data(chain, NULL);
+  }
+  for (int i = 0; i < 4; ++i) {
+    add_edge(chain, i, i + 1, 0);
+  }
+  GraphVisitor skip = {.discover=count_discover, .examine_edge=count_edge, .ctx=&count};
+  for (int bfs = 0; bfs <= 1; ++bfs) {
+    memset(&count, 0, sizeof(VisitCount));
+    count.target = -1;
+    int ret = bfs ? graph_bfs_visit(chain, 0, &skip) : graph_dfs_visit(chain, 0, &skip);
+    assert(ret == VISIT_CONTINUE);
+    assert(count.discovered == 1);
+    assert(count.edges == 1);
+  }
+  GraphVisitor skip_vertex = {.discover=skip_discover, .finish=count_finish, .ctx=&count};
+  for (int bfs = 0; bfs <= 1; ++bfs) {
+    memset(&count, 0, sizeof(VisitCount));
+    count.target = -1;
+    int ret = bfs ? graph_bfs_visit(chain, 0, &skip_vertex) : graph_dfs_visit(chain, 0, &skip_vertex);
+    assert(ret == VISIT_CONTINUE);
+    assert(count.discovered == 2);
+    assert(count.finished == 2);
+  }
+
+  // bfs stops when a leaf is discovered, before the center is finished or another level is taken out
+  Graph *star = create_graph(1, 0);
+  for (int i = 0; i < 50; ++i) {
+    add_graph_data(star, NULL);
+  }
+  for (int i = 1; i < 50; ++i) {
+    add_edge(star, 0, i, 0);
+    add_edge(star, i, (i + 1) % 50, 0);
+  }
+  memset(&full, 0, sizeof(VisitCount));
+  full.target = -1;
+  visitor.ctx = &full;
+  assert(graph_bfs_visit(star, 0, &visitor) == VISIT_CONTINUE);
+  visitor.ctx = &count;
+  // the source, then the leaves of the center in their order up to 7
+  int leaves = 0;
+  while (full.order[1 + leaves] != 7) leaves++;
+  memset(&count, 0, sizeof(VisitCount));
+  count.target = 7;
+  assert(graph_bfs_visit(star, 0, &visitor) == VISIT_STOP);
+  assert(count.finished == 0);
+  assert(count.discovered == 1 + leaves + 1);
+  assert(memcmp(count.order, full.order, sizeof(int) * count.discovered) == 0);
+  free_graph(star);
+
+  assert(graph_dfs_visit(chain, 10, &skip) == GRAPH_ERROR);
+  assert(graph_bfs_visit(chain, 10, &skip) == GRAPH_ERROR);
+  free_graph(chain);
+  free_graph(graph);
+}
+
+void test_local_search() {
+  int size = 1000;
+  Graph *graph = create_random_graph(size, size * 3, 1, 1, 31);
+  // dijkstra needs an out edge on every vertex
+  for (int i = 0; i < size; ++i) {
+    add_edge(graph, i, (i + 1) % size, 150);
+  }
+  SearchWorkspace *workspace = create_search_workspace();
+  for (int s = 0; s < 50; s += 7) {
+    for (int k = 0; k <= 3; ++k) {
+      VertexLabel *hops = k_hop_neighborhood(graph, s, k, k % 2 ? workspace : NULL);
+      Hashtable *pre_map = single_source_path(graph, s, BFS);
+      int expect = 0;
+      HashtableIterator *iter = hashtable_iterator(pre_map);
+      while (hashtable_iter_has_next(iter)) {
+        int *id = table_entry_key(hashtable_next_entry(iter));
+        if (path_depth(pre_map, *id) <= k) expect++;
+      }
+      free_hashtable_iter(iter);
+      assert(hops->size == expect);
+      for (int i = 0; i < hops->size; ++i) {
+        assert(hops->label[i] == path_depth(pre_map, hops->id_list[i]));
+        assert(i == 0 || hops->label[i] >= hops->label[i - 1]);
+      }
+      free_hash_table(pre_map);
+      free_vertex_label(hops);
+    }
+
+    Hashtable *dis = dijkstra(graph, s);
+    for (int radius = 0; radius <= 200; radius += 50) {
+      VertexLabel *within = dijkstra_within(graph, s, radius, workspace);
+      int expect = 0;
+      HashtableIterator *iter = hashtable_iterator(dis);
+      while (hashtable_iter_has_next(iter)) {
+        KVEntry *entry = hashtable_next_entry(iter);
+        if (*(int *) table_entry_value(entry) <= radius) expect++;
+      }
+      free_hashtable_iter(iter);
+      assert(within->size == expect);
+      for (int i = 0; i < within->size; ++i) {
+        assert(within->label[i] == *(int *) get_hash_table(dis, &within->id_list[i]));
+        assert(i == 0 || within->label[i] >= within->label[i - 1]);
+      }
+      free_vertex_label(within);
+    }
+    free_hash_table(dis);
+  }
+  assert(k_hop_neighborhood(graph, size, 1, workspace) == NULL);
+  assert(dijkstra_within(graph, 0, -1, NULL) == NULL);
+  add_graph_data_with_id(graph, size, NULL);
+  add_edge(graph, 0, size, -3);
+  assert(dijkstra_within(graph, 0, 1000, workspace) == NULL);
+  assert(dijkstra_within(graph, 0, 1000, NULL) == NULL);
+  free_search_workspace(workspace);
+  free_graph(graph);
+}
+
+void test_scc_pearce() {
+  int size = 2000;
+  Graph *graph = create_random_graph(size, size * 2, 1, 0, 32);
+  VertexLabel *scc = scc_pearce(graph);
+  assert(scc->size == size);
+  Hashtable *label = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(label, free, free);
+  for (int i = 0; i < scc->size; ++i) {
+    put_hash_table(label, new_id(scc->id_list[i]), new_id(scc->label[i]));
+  }
+  Hashtable *components = scc_kosaraju(graph);
+  HashtableIterator *iter = hashtable_iterator(components);
+  int max_label = -1;
+  while (hashtable_iter_has_next(iter)) {
+    LinkedList *ll = table_entry_value(hashtable_next_entry(iter));
+    LinkedListNode *head = head_of_list(ll);
+    int c = *(int *) get_hash_table(label, data_of_node_linked_list(head));
+    LinkedListNode *node = head;
+    do {
+      assert(*(int *) get_hash_table(label, data_of_node_linked_list(node)) == c);
+      node = next_node_linked_list(node);
+    } while (node != head);
+    if (c > max_label) max_label = c;
+    free_linked_list(ll, free);
+  }
+  free_hashtable_iter(iter);
+  assert(max_label + 1 == size_of_hash_table(components));
+  free_hash_table(components);
+  // reverse topological order
+  for (int i = 0; i < size; ++i) {
+    Hashset *adj = get_adj_set(graph, i);
+    if (!adj) continue;
+    HashsetIterator *edges = hashset_iterator(adj);
+    while (hashset_iter_has_next(edges)) {
+      Edge *edge = set_entry_key(hashset_next_entry(edges));
+      int from = get_edge_from(edge);
+      int to = get_edge_to(edge);
+      assert(*(int *) get_hash_table(label, &from) >= *(int *) get_hash_table(label, &to));
+    }
+    free_hashset_iter(edges);
+  }
+  free_hash_table(label);
+  free_vertex_label(scc);
+  free_graph(graph);
+
+  // a long circle is one component
+  size = 100000;
+  graph = create_graph(1, 0);
+  for (int i = 0; i < size; ++i) {
+    add_graph_data(graph, NULL);
+  }
+  for (int i = 0; i < size; ++i) {
+    add_edge(graph, i, (i + 1) % size, 0);
+  }
+  scc = scc_pearce(graph);
+  for (int i = 0; i < scc->size; ++i) {
+    assert(scc->label[i] == 0);
+  }
+  free_vertex_label(scc);
+  free_graph(graph);
+}
+
+static void assert_same_partition(VertexLabel *l1, VertexLabel *l2) {
+  assert(l1->size == l2->size);
+  Hashtable *label = new_hash_table(int_hash, int_compare);
+  register_hashtable_free_functions(label, free, free);
+  for (int i = 0; i < l2->size; ++i) {
+    put_hash_table(label, new_id(l2->id_list[i]), new_id(l2->label[i]));
+  }
+  // labels must map one to one
+  int *map = malloc(sizeof(int) * l1->size);
+  int *back = malloc(sizeof(int) * l1->size);
+  for (int i = 0; i < l1->size; ++i) {
+    map[i] = -1;
+    back[i] = -1;
+  }
+  for (int i = 0; i < l1->size; ++i) {
+    int c1 = l1->label[i];
+    int c2 = *(int *) get_hash_table(label, &l1->id_list[i]);
+    assert(c1 >= 0 && c1 < l1->size && c2 >= 0 && c2 < l1->size);
+    if (map[c1] < 0) map[c1] = c2;
+    if (back[c2] < 0) back[c2] = c1;
+    assert(map[c1] == c2);
+    assert(back[c2] == c1);
+  }
+  free(map);
+  free(back);
+  free_hash_table(label);
+}
+
+void test_scc_par() {
+  int size = 3000;
+  Graph *graph = create_random_graph(size, size * 2, 1, 0, 33);
+  // a giant component on top of the random one
+  for (int i = 0; i < size / 2; ++i) {
+    add_edge(graph, i, (i + 1) % (size / 2), 0);
+  }
+  VertexLabel *expect = scc_pearce(graph);
+  for (int threads = 1; threads <= 4; threads += 3) {
+    VertexLabel *scc = scc_par(graph, threads);
+    assert_same_partition(scc, expect);
+    free_vertex_label(scc);
+  }
+  free_vertex_label(expect);
+  free_graph(graph);
+
+  graph = create_random_graph(size, size, 1, 0, 34);
+  expect = scc_pearce(graph);
+  VertexLabel *scc = scc_par(graph, 4);
+  assert_same_partition(scc, expect);
+  free_vertex_label(scc);
+  free_vertex_label(expect);
+  free_graph(graph);
+}
+
+void test_graph_components_uf() {
+  IdUnionFind *uf = create_id_uf();
+  // designated ids far beyond the amount of vertexes
+  assert(id_uf_add(uf, 1000000));
+  assert(!id_uf_add(uf, 1000000));
+  assert(id_uf_union(uf, 1000000, -7));
+  assert(id_uf_union(uf, 42, 43));
+  assert(!id_uf_union(uf, -7, 1000000));
+  assert(id_uf_count(uf) == 2);
+  assert(id_uf_same_set(uf, -7, 1000000));
+  assert(!id_uf_same_set(uf, 42, -7));
+  assert(id_uf_find(uf, 5) == 5);
+  assert(id_uf_union(uf, 43, -7));
+  assert(id_uf_find(uf, 42) == id_uf_find(uf, 1000000));
+  assert(id_uf_count(uf) == 1);
+  free_id_uf(uf);
+
+  for (int directed = 0; directed <= 1; ++directed) {
+    int size = 2000;
+    Graph *graph = create_random_graph(size, size / 2, directed, 0, 34);
+    VertexLabel *cc = graph_components_uf(graph);
+    Graph *ug = create_graph(0, 0);
+    for (int i = 0; i < size; ++i) {
+      add_graph_data(ug, NULL);
+    }
+    for (int i = 0; i < size; ++i) {
+      Hashset *adj = get_adj_set(graph, i);
+      if (!adj) continue;
+      HashsetIterator *iter = hashset_iterator(adj);
+      while (hashset_iter_has_next(iter)) {
+        Edge *edge = set_entry_key(hashset_next_entry(iter));
+        add_edge(ug, get_edge_from(edge), get_edge_to(edge), 0);
+      }
+      free_hashset_iter(iter);
+    }
+    int c = component_count(ug);
+    Hashtable *cmap = graph_components(ug);
+    VertexLabel expect = {.id_list=malloc(sizeof(int) * size), .label=malloc(sizeof(int) * size), .size=0};
+    for (int i = 0; i < size_of_hash_table(cmap); ++i) {
+      ArrayList *al = get_hash_table(cmap, &i);
+      for (int j = 0; j < al->size; ++j) {
+        int *id = get_data_arraylist(al, j);
+        expect.id_list[expect.size] = *id;
+        expect.label[expect.size++] = i;
+        free(id);
+      }
+    }
+    assert(size_of_hash_table(cmap) == c);
+    assert_same_partition(cc, &expect);
+    free(expect.id_list);
+    free(expect.label);
+    free_hash_table(cmap);
+    free_graph(ug);
+    free_vertex_label(cc);
+    free_graph(graph);
+  }
+}
+
+void test_graph_components_par() {
+  for (int directed = 0; directed <= 1; ++directed) {
+    int size = 5000;
+    Graph *graph = create_random_graph(size, size * 3 / 4, directed, 0, 35);
+    // a giant component for the sampling to skip
+    for (int i = 0; i < size / 2; i += 2) {
+      add_edge(graph, i + 2, i, 0);
+    }
+    VertexLabel *expect = graph_components_uf(graph);
+    for (int threads = 1; threads <= 4; threads += 3) {
+      VertexLabel *cc = graph_components_par(graph, threads);
+      assert_same_partition(cc, expect);
+      free_vertex_label(cc);
+    }
+    free_vertex_label(expect);
+    free_graph(graph);
+  }
+}
+
+void test_connectivity_index() {
+  Graph *directed = create_graph(1, 0);
+  assert(enable_connectivity_index(directed) == GRAPH_ERROR);
+  free_graph(directed);
+
+  int size = 300;
+  Graph *graph = create_graph(0, 0);
+  Graph *plain = create_graph(0, 0);
+  for (int i = 0; i < size / 2; ++i) {
+    add_graph_data(graph, NULL);
+    add_graph_data(plain, NULL);
+  }
+  assert(enable_connectivity_index(graph) == GRAPH_SUCCESS);
+  // vertexes added after the index is enabled
+  for (int i = size / 2; i < size; ++i) {
+    add_graph_data(graph, NULL);
+    add_graph_data(plain, NULL);
+  }
+  srand(36);
+  for (int i = 0; i < size; ++i) {
+    int from = rand() % size;
+    int to = rand() % size;
+    add_edge(graph, from, to, 0);
+    add_edge(plain, from, to, 0);
+    if (i % 10 == 0) {
+      assert(component_count(graph) == component_count(plain));
+      for (int j = 0; j < 20; ++j) {
+        int v1 = rand() % size;
+        int v2 = rand() % size;
+        assert(has_path(graph, v1, v2) == has_path(plain, v1, v2));
+      }
+    }
+  }
+  // removing makes the index stale
+  for (int i = 0; i < size; ++i) {
+    Hashset *adj = get_adj_set(plain, i);
+    if (!adj || size_of_hash_set(adj) == 0) continue;
+    HashsetIterator *iter = hashset_iterator(adj);
+    Edge *edge = set_entry_key(hashset_next_entry(iter));
+    int to = get_edge_to(edge);
+    free_hashset_iter(iter);
+    remove_edge(graph, i, to);
+    remove_edge(plain, i, to);
+    if (i % 30 == 0) {
+      assert(component_count(graph) == component_count(plain));
+      for (int j = 0; j < 20; ++j) {
+        int v1 = rand() % size;
+        int v2 = rand() % size;
+        assert(has_path(graph, v1, v2) == has_path(plain, v1, v2));
+      }
+    }
+  }
+  remove_vertex(graph, 0);
+  remove_vertex(plain, 0);
+  assert(component_count(graph) == component_count(plain));
+  add_edge(graph, 1, 2, 0);
+  add_edge(plain, 1, 2, 0);
+  assert(has_path(graph, 1, 2));
+  assert(component_count(graph) == component_count(plain));
+  disable_connectivity_index(graph);
+  assert(component_count(graph) == component_count(plain));
+  free_graph(plain);
+  free_graph(graph);
+}
+
+void test_dynamic_connectivity() {
+  Graph *directed = create_graph(1, 0);
+  assert(enable_dynamic_connectivity(directed) == GRAPH_ERROR);
+  free_graph(directed);
+
+  int size = 200;
+  Graph *graph = create_random_graph(size, size / 2, 0, 0, 37);
+  Graph *plain = create_random_graph(size, size / 2, 0, 0, 37);
+  assert(enable_dynamic_connectivity(graph) == GRAPH_SUCCESS);
+  assert(component_count(graph) == component_count(plain));
+  srand(370);
+  for (int i = 0; i < 4000; ++i) {
+    int from = rand() % size;
+    int to = rand() % size;
+    if (rand() % 3) {
+      if (has_vertex(graph, from) && get_adj_set(graph, from)) {
+        // remove an existing edge of from
+        Hashset *adj = get_adj_set(graph, from);
+        if (size_of_hash_set(adj) > 0) {
+          HashsetIterator *iter = hashset_iterator(adj);
+          to = get_edge_to(set_entry_key(hashset_next_entry(iter)));
+          free_hashset_iter(iter);
+          assert(remove_edge(graph, from, to) == remove_edge(plain, from, to));
+        }
+      }
+    } else {
+      assert(add_edge(graph, from, to, 0) == add_edge(plain, from, to, 0));
+    }
+    if (i == 2000) {
+      remove_vertex(graph, 5);
+      remove_vertex(plain, 5);
+    }
+    if (i % 50 == 0) {
+      assert(component_count(graph) == component_count(plain));
+      for (int j = 0; j < 20; ++j) {
+        int v1 = rand() % size;
+        int v2 = rand() % size;
+        assert(has_path(graph, v1, v2) == has_path(plain, v1, v2));
+      }
+    }
+  }
+  add_graph_data_with_id(graph, 5, NULL);
+  add_graph_data_with_id(plain, 5, NULL);
+  add_edge(graph, 5, 6, 0);
+  add_edge(plain, 5, 6, 0);
+  assert(has_path(graph, 5, 6));
+  assert(component_count(graph) == component_count(plain));
+  // adding an existing edge again adds nothing, a single remove takes the edge away
+  int components = component_count(graph);
+  int a = size, b = size + 1, c = size + 2;
+  Graph *both[2] = {graph, plain};
+  for (int i = 0; i < 2; ++i) {
+    add_graph_data_with_id(both[i], a, NULL);
+    add_graph_data_with_id(both[i], b, NULL);
+    add_graph_data_with_id(both[i], c, NULL);
+    add_edge(both[i], a, b, 0);
+    add_edge(both[i], b, c, 0);
+    add_edge(both[i], a, c, 0);
+    assert(add_edge(both[i], a, b, 0) == GRAPH_SUCCESS);
+    assert(add_edge(both[i], c, a, 0) == GRAPH_SUCCESS);
+  }
+  assert(component_count(graph) == components + 1);
+  for (int i = 0; i < 2; ++i) {
+    assert(remove_edge(both[i], a, b));
+  }
+  // a and b only meet through c now
+  assert(has_path(graph, a, b) && has_path(graph, b, a));
+  assert(component_count(graph) == components + 1);
+  assert(component_count(graph) == component_count(plain));
+  for (int i = 0; i < 2; ++i) {
+    assert(remove_edge(both[i], b, c));
+  }
+  assert(!has_path(graph, a, b) && has_path(graph, a, c));
+  assert(component_count(graph) == components + 2);
+  assert(component_count(graph) == component_count(plain));
+  // the edge is gone, removing it again changes nothing
+  for (int i = 0; i < 2; ++i) {
+    assert(!remove_edge(both[i], a, b));
+  }
+  assert(!has_path(graph, a, b) && has_path(graph, a, c));
+  assert(component_count(graph) == components + 2);
+  for (int i = 0; i < 2; ++i) {
+    assert(remove_edge(both[i], c, a));
+  }
+  assert(!has_path(graph, a, c));
+  assert(component_count(graph) == components + 3);
+  assert(component_count(graph) == component_count(plain));
+  disable_dynamic_connectivity(graph);
+  assert(component_count(graph) == component_count(plain));
+  free_graph(plain);
+  free_graph(graph);
+}
+
+static int block_contains(Biconnectivity *bc, int block, int id) {
+  for (int i = bc->block_offset[block]; i < bc->block_offset[block + 1]; ++i) {
+    if (bc->block_vertex[i] == id) return 1;
+  }
+  return 0;
+}
+
+void test_biconnectivity() {
+  Graph *directed = create_graph(1, 0);
+  assert(biconnectivity(directed) == NULL);
+  free_graph(directed);
+
+  for (unsigned int seed = 380; seed < 385; ++seed) {
+    int size = 60;
+    int edges = 40 + (int) (seed - 380) * 15;
+    Graph *graph = create_random_graph(size, edges, 0, 0, seed);
+    Biconnectivity *bc = biconnectivity(graph);
+    int components = component_count(graph);
+
+    // an edge is a bridge iff removing it adds a component, and it is in exactly one block
+    int edge_count = 0;
+    int bridge_count = 0;
+    for (int u = 0; u < size; ++u) {
+      for (int v = u + 1; v < size; ++v) {
+        if (!get_edge(graph, u, v)) continue;
+        edge_count++;
+        int is_bridge = 0;
+        for (int i = 0; i < bc->bridge_size; ++i) {
+          int a = bc->bridges[2 * i];
+          int b = bc->bridges[2 * i + 1];
+          if ((a == u && b == v) || (a == v && b == u)) is_bridge = 1;
+        }
+        bridge_count += is_bridge;
+        remove_edge(graph, u, v);
+        assert((component_count(graph) > components) == is_bridge);
+        add_edge(graph, u, v, 0);
+        int in_blocks = 0;
+        for (int i = 0; i < bc->block_size; ++i) {
+          in_blocks += block_contains(bc, i, u) && block_contains(bc, i, v);
+        }
+        assert(in_blocks == 1);
+      }
+    }
+    assert(bridge_count == bc->bridge_size);
+
+    // a vertex is a cut point iff removing it adds a component, and only cut points are in several blocks
+    for (int v = 0; v < size; ++v) {
+      int is_cut = 0;
+      for (int i = 0; i < bc->cut_point_size; ++i) {
+        if (bc->cut_points[i] == v) is_cut = 1;
+      }
+      Graph *removed = create_random_graph(size, edges, 0, 0, seed);
+      remove_vertex(removed, v);
+      assert((component_count(removed) > components) == is_cut);
+      free_graph(removed);
+      int in_blocks = 0;
+      for (int i = 0; i < bc->block_size; ++i) {
+        in_blocks += block_contains(bc, i, v);
+      }
+      assert(is_cut ? in_blocks > 1 : in_blocks == 1);
+    }
+    printf("edges: %d, bridges: %d, cut points: %d, blocks: %d\n", edge_count, bc->bridge_size,
+           bc->cut_point_size, bc->block_size);
+    free_biconnectivity(bc);
+    free_graph(graph);
+  }
+  fflush(stdout);
+}
+
+void test_cut_index() {
+  Graph *directed = create_graph(1, 0);
+  assert(create_cut_index(directed) == NULL);
+  free_graph(directed);
+
+  for (unsigned int seed = 390; seed < 394; ++seed) {
+    int size = 40;
+    int edges = 30 + (int) (seed - 390) * 15;
+    Graph *graph = create_random_graph(size, edges, 0, 0, seed);
+    CutIndex *index = create_cut_index(graph);
+    srand(seed * 7);
+    for (int x = 0; x < size; ++x) {
+      Graph *removed = create_random_graph(size, edges, 0, 0, seed);
+      remove_vertex(removed, x);
+      for (int i = 0; i < 40; ++i) {
+        int a = rand() % size;
+        int b = rand() % size;
+        int expected = a != x && b != x && has_path(graph, a, b) && !has_path(removed, a, b);
+        assert(cut_vertex_separates(index, x, a, b) == expected);
+      }
+      free_graph(removed);
+    }
+    for (int u = 0; u < size; ++u) {
+      for (int v = 0; v < size; ++v) {
+        int exists = get_edge(graph, u, v) != NULL;
+        if (exists) remove_edge(graph, u, v);
+        for (int i = 0; i < 10; ++i) {
+          int a = rand() % size;
+          int b = rand() % size;
+          int expected = 0;
+          if (exists) {
+            add_edge(graph, u, v, 0);
+            expected = has_path(graph, a, b);
+            remove_edge(graph, u, v);
+            expected = expected && !has_path(graph, a, b);
+          }
+          assert(cut_edge_separates(index, u, v, a, b) == expected);
+        }
+        if (exists) add_edge(graph, u, v, 0);
+      }
+    }
+    assert(cut_vertex_separates(index, size, 0, 1) == 0);
+    free_cut_index(index);
+    free_graph(graph);
+  }
+}
+
+static int scc_count(Graph *graph) {
+  VertexLabel *scc = scc_pearce(graph);
+  int count = 0;
+  for (int i = 0; i < scc->size; ++i) {
+    if (scc->label[i] + 1 > count) count = scc->label[i] + 1;
+  }
+  free_vertex_label(scc);
+  return count;
+}
+
+void test_strong_bridge() {
+  for (unsigned int seed = 400; seed < 406; ++seed) {
+    int size = 40;
+    int edges = 50 + (int) (seed - 400) * 15;
+    Graph *graph = create_random_graph(size, edges, 1, 0, seed);
+    int components = scc_count(graph);
+
+    LinkedList *bridges = find_bridge(graph);
+    Hashset *bridge_set = new_hash_set(int_hash, int_compare);
+    register_hashset_free_functions(bridge_set, free);
+    if (list_size(bridges) > 0) {
+      LinkedListNode *head = head_of_list(bridges);
+      LinkedListNode *node = head;
+      do {
+        Edge *edge = data_of_node_linked_list(node);
+        put_hash_set(bridge_set, new_id(get_edge_from(edge) * size + get_edge_to(edge)));
+        node = next_node_linked_list(node);
+      } while (node != head);
+    }
+    assert(size_of_hash_set(bridge_set) == list_size(bridges));
+    for (int u = 0; u < size; ++u) {
+      for (int v = 0; v < size; ++v) {
+        if (!get_edge(graph, u, v)) continue;
+        int key = u * size + v;
+        remove_edge(graph, u, v);
+        assert((scc_count(graph) > components) == contains_in_hash_set(bridge_set, &key));
+        add_edge(graph, u, v, 0);
+      }
+    }
+
+    LinkedList *points = find_cut_point(graph);
+    Hashset *point_set = new_hash_set(int_hash, int_compare);
+    register_hashset_free_functions(point_set, NULL);
+    if (list_size(points) > 0) {
+      LinkedListNode *head = head_of_list(points);
+      LinkedListNode *node = head;
+      do {
+        put_hash_set(point_set, data_of_node_linked_list(node));
+        node = next_node_linked_list(node);
+      } while (node != head);
+    }
+    for (int v = 0; v < size; ++v) {
+      Graph *removed = create_random_graph(size, edges, 1, 0, seed);
+      remove_vertex(removed, v);
+      assert((scc_count(removed) > components) == contains_in_hash_set(point_set, &v));
+      free_graph(removed);
+    }
+    printf("strong bridges: %d, strong articulation points: %d\n", list_size(bridges), list_size(points));
+
+    free_hash_set(bridge_set);
+    free_hash_set(point_set);
+    free_linked_list(bridges, NULL);
+    free_linked_list(points, free);
+    free_graph(graph);
+  }
+  fflush(stdout);
+}
+
+void test_dominator_tree() {
+  /**
+   *        0
+   *       / \
+   *      1   2
+   *       \ /
+   *        3 -> 4 -> 5
+   *             ^    |
+   *             +----+
+   */
+  Graph *graph = create_graph(1, 0);
+  for (int i = 0; i < 7; ++i) {
+    add_graph_data(graph, NULL);
+  }
+  add_edge(graph, 0, 1, 0);
+  add_edge(graph, 0, 2, 0);
+  add_edge(graph, 1, 3, 0);
+  add_edge(graph, 2, 3, 0);
+  add_edge(graph, 3, 4, 0);
+  add_edge(graph, 4, 5, 0);
+  add_edge(graph, 5, 4, 0);
+  add_edge(graph, 6, 0, 0);
+  assert(dominator_tree(graph, 7) == NULL);
+  VertexLabel *tree = dominator_tree(graph, 0);
+  assert(tree->size == 6);
+  int expected[] = {0, 0, 0, 0, 3, 4};
+  for (int i = 0; i < tree->size; ++i) {
+    assert(tree->label[i] == expected[tree->id_list[i]]);
+  }
+  free_vertex_label(tree);
+  free_graph(graph);
+
+  // d strictly dominates v iff removing d makes v unreachable from the root
+  for (unsigned int seed = 410; seed < 414; ++seed) {
+    int size = 40;
+    int edges = 50 + (int) (seed - 410) * 20;
+    graph = create_random_graph(size, edges, 1, 0, seed);
+    tree = dominator_tree(graph, 0);
+    int *idom = malloc(sizeof(int) * size);
+    for (int v = 0; v < size; ++v) {
+      idom[v] = -1;
+    }
+    for (int i = 0; i < tree->size; ++i) {
+      idom[tree->id_list[i]] = tree->label[i];
+    }
+    assert(idom[0] == 0);
+    for (int v = 1; v < size; ++v) {
+      assert((idom[v] >= 0) == has_path(graph, 0, v));
+    }
+    for (int d = 1; d < size; ++d) {
+      Graph *removed = create_random_graph(size, edges, 1, 0, seed);
+      remove_vertex(removed, d);
+      for (int v = 1; v < size; ++v) {
+        if (v == d || idom[v] < 0) continue;
+        int dominated = 0;
+        for (int u = idom[v]; u != 0; u = idom[u]) {
+          if (u == d) dominated = 1;
+        }
+        assert(dominated == !has_path(removed, 0, v));
+      }
+      free_graph(removed);
+    }
+    free(idom);
+    free_vertex_label(tree);
+    free_graph(graph);
+  }
+}
+
+static long mst_weight(LinkedList *mst) {
+  long weight = 0;
+  if (list_size(mst) == 0) return 0;
+  LinkedListNode *head = head_of_list(mst);
+  LinkedListNode *node = head;
+  do {
+    weight += get_edge_weight(data_of_node_linked_list(node));
+    node = next_node_linked_list(node);
+  } while (node != head);
+  return weight;
+}
+
+void test_filter_kruskal() {
+  Graph *disconnected = create_random_graph(10, 3, 0, 1, 420);
+  assert(filter_kruskal_mst(disconnected) == NULL);
+  free_graph(disconnected);
+
+  for (unsigned int seed = 420; seed < 424; ++seed) {
+    int size = 3000;
+    Graph *graph = create_random_graph(size, size * 8, 0, 1, seed);
+    for (int i = 0; i < size; ++i) {
+      // a ring keeps the graph connected, with heavy and equal weights
+      add_edge(graph, i, (i + 1) % size, seed % 2 ? 100 : -5);
+    }
+    // kruskal_mst is filter_kruskal_mst, compare with the other algorithms
+    LinkedList *expected = boruvka_msf(graph, 2);
+    LinkedList *prim = prim_mst(graph);
+    LinkedList *mst = filter_kruskal_mst(graph);
+    assert(list_size(mst) == size - 1);
+    assert(list_size(expected) == size - 1);
+    assert(mst_weight(mst) == mst_weight(expected));
+    assert(mst_weight(mst) == mst_weight(prim));
+    free_linked_list(expected, free);
+    free_linked_list(prim, free);
+    free_linked_list(mst, free);
+    free_graph(graph);
+  }
+
+  // every weight equal
+  int size = 2000;
+  Graph *graph = create_graph(0, 1);
+  for (int i = 0; i < size; ++i) {
+    add_graph_data(graph, NULL);
+  }
+  for (int i = 0; i < size; ++i) {
+    add_edge(graph, i, (i + 1) % size, 3);
+    add_edge(graph, i, (i + 7) % size, 3);
+  }
+  LinkedList *mst = filter_kruskal_mst(graph);
+  assert(list_size(mst) == size - 1);
+  assert(mst_weight(mst) == 3L * (size - 1));
+  free_linked_list(mst, free);
+  free_graph(graph);
+}
+
+void test_boruvka_msf() {
+  for (unsigned int seed = 430; seed < 434; ++seed) {
+    int size = 3000;
+    // sparse enough to leave several components
+    Graph *graph = create_random_graph(size, size * (seed % 2 ? 3 : 1), 0, 1, seed);
+    int components = component_count(graph);
+    // joining every component to an extra vertex by heavy edges gives a spanning tree of msf and them
+    Graph *joined = create_random_graph(size, size * (seed % 2 ? 3 : 1), 0, 1, seed);
+    add_graph_data_with_id(joined, size, NULL);
+    for (int i = 0; i < size; ++i) {
+      add_edge(joined, i, size, 1000000);
+    }
+    LinkedList *expected = kruskal_mst(joined);
+    for (int threads = 1; threads <= 4; threads += 3) {
+      LinkedList *msf = boruvka_msf(graph, threads);
+      assert(list_size(msf) == size - components);
+      assert(mst_weight(msf) == mst_weight(expected) - 1000000L * components);
+      free_linked_list(msf, free);
+    }
+    free_linked_list(expected, free);
+    free_graph(joined);
+    free_graph(graph);
+  }
+  Graph *empty = create_graph(0, 1);
+  LinkedList *msf = boruvka_msf(empty, 2);
+  assert(list_size(msf) == 0);
+  free_linked_list(msf, free);
+  free_graph(empty);
+}
+
+typedef struct SpanningCollect {
+  int edges;
+  long weight;
+  int last_weight;
+  int ascending;
+} SpanningCollect;
+
+static void collect_spanning_edge(void *ctx, int from, int to, int weight) {
+  (void) from;
+  (void) to;
+  SpanningCollect *c = ctx;
+  if (c->edges > 0 && weight < c->last_weight) c->ascending = 0;
+  c->edges++;
+  c->weight += weight;
+  c->last_weight = weight;
+}
+
+void test_msf_stream() {
+  for (unsigned int seed = 440; seed < 444; ++seed) {
+    int size = 2000;
+    Graph *graph = create_random_graph(size, size * (seed % 2 ? 3 : 1), 0, 1, seed);
+    int components = component_count(graph);
+    SpanningCollect kruskal = {0, 0, 0, 1};
+    SpanningCollect prim = {0, 0, 0, 1};
+    assert(kruskal_msf(graph, collect_spanning_edge, &kruskal) == components);
+    assert(prim_msf(graph, collect_spanning_edge, &prim) == components);
+    assert(kruskal.ascending);
+    assert(kruskal.edges == size - components);
+    assert(prim.edges == size - components);
+    assert(kruskal.weight == prim.weight);
+    LinkedList *msf = boruvka_msf(graph, 2);
+    assert(mst_weight(msf) == kruskal.weight);
+    free_linked_list(msf, free);
+    if (components > 1) {
+      assert(kruskal_mst(graph) == NULL);
+      assert(prim_mst(graph) == NULL);
+    } else {
+      LinkedList *mst = prim_mst(graph);
+      assert(mst_weight(mst) == kruskal.weight);
+      free_linked_list(mst, free);
+    }
+    free_graph(graph);
+  }
+}
+
+void test_prim_dense() {
+  int size = 300;
+  Graph *graph = create_graph(0, 1);
+  for (int i = 0; i < size; ++i) {
+    add_graph_data(graph, NULL);
+  }
+  srand(450);
+  for (int i = 0; i < size; ++i) {
+    for (int j = i + 1; j < size; ++j) {
+      add_edge(graph, i, j, rand() % 10000 - 5000);
+    }
+  }
+  SpanningCollect kruskal = {0, 0, 0, 1};
+  SpanningCollect prim = {0, 0, 0, 1};
+  assert(kruskal_msf(graph, collect_spanning_edge, &kruskal) == 1);
+  assert(prim_msf(graph, collect_spanning_edge, &prim) == 1);
+  assert(prim.edges == size - 1);
+  assert(prim.weight == kruskal.weight);
+  free_graph(graph);
+}
+
+void test_incremental_msf() {
+  Graph *unweighted = create_graph(0, 0);
+  assert(enable_incremental_msf(unweighted) == GRAPH_ERROR);
+  free_graph(unweighted);
+
+  int size = 300;
+  Graph *graph = create_random_graph(size, size / 2, 0, 1, 460);
+  assert(enable_incremental_msf(graph) == GRAPH_SUCCESS);
+  srand(461);
+  for (int i = 0; i < 3000; ++i) {
+    int from = rand() % size;
+    int to = rand() % size;
+    int weight = rand() % 1000 - 200;
+    if (i % 500 == 250) {
+      remove_edge(graph, from, to);
+      Hashset *adj = get_adj_set(graph, from);
+      if (adj && size_of_hash_set(adj) > 0) {
+        HashsetIterator *iter = hashset_iterator(adj);
+        Edge *edge = set_entry_key(hashset_next_entry(iter));
+        free_hashset_iter(iter);
+        set_weight(graph, get_edge_from(edge), get_edge_to(edge), weight);
+      }
+    } else if (i == 1500) {
+      remove_vertex(graph, from);
+      add_graph_data_with_id(graph, from, NULL);
+    } else {
+      add_edge(graph, from, to, weight);
+    }
+    if (i % 100 == 0) {
+      SpanningCollect expected = {0, 0, 0, 1};
+      SpanningCollect kept = {0, 0, 0, 1};
+      int trees = kruskal_msf(graph, collect_spanning_edge, &expected);
+      assert(incremental_msf(graph, collect_spanning_edge, &kept) == trees);
+      assert(kept.edges == expected.edges);
+      assert(kept.weight == expected.weight);
+      assert(incremental_msf_weight(graph) == expected.weight);
+    }
+  }
+  disable_incremental_msf(graph);
+  free_graph(graph);
+}
+
+// check capacity and conservation of a flow map over vertexes 0 ... size-1, return the flow out of source
+static int check_flow(Graph *graph, Hashtable *flow_map, int size, int source, int to) {
+  int *net = calloc(size, sizeof(int));
+  int edges = 0;
+  HashtableIterator *iter = hashtable_iterator(flow_map);
+  while (hashtable_iter_has_next(iter)) {
+    Hashset *adj = table_entry_value(hashtable_next_entry(iter));
+    HashsetIterator *iterator = hashset_iterator(adj);
+    while (hashset_iter_has_next(iterator)) {
+      Edge *edge = set_entry_key(hashset_next_entry(iterator));
+      int f = get_edge_weight(edge);
+      assert(f >= 0 && f <= get_edge_weight(get_edge(graph, get_edge_from(edge), get_edge_to(edge))));
+      net[get_edge_from(edge)] += f;
+      net[get_edge_to(edge)] -= f;
+      edges++;
+    }
+    free_hashset_iter(iterator);
+  }
+  free_hashtable_iter(iter);
+  assert(edges == edge_count(graph));
+  for (int i = 0; i < size; ++i) {
+    if (i != source && i != to) assert(net[i] == 0);
+  }
+  assert(net[source] == -net[to]);
+  int out = net[source];
+  free(net);
+  return out;
+}
+
+void test_dinic() {
+  int size = 4;
+  Graph *graph = create_graph(1, 1);
+  for (int i = 0; i < size; ++i) {
+    int id = add_graph_data(graph, NULL);
+    assert(id == i);
+  }
+  add_edge(graph, 0, 1, 3);
+  add_edge(graph, 0, 2, 2);
+  add_edge(graph, 1, 2, 5);
+  add_edge(graph, 1, 3, 2);
+  add_edge(graph, 2, 3, 3);
+  int maxflow = 0;
+  Hashtable *flow_map = dinic_max_flow(graph, 0, 3, &maxflow);
+  assert(maxflow == 5);
+  assert(check_flow(graph, flow_map, size, 0, 3) == 5);
+  register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+  free_hash_table(flow_map);
+  // opposite edges are two arcs of their own
+  add_edge(graph, 2, 0, 4);
+  add_edge(graph, 3, 1, 1);
+  flow_map = dinic_max_flow(graph, 2, 3, &maxflow);
+  assert(maxflow == 5);
+  assert(check_flow(graph, flow_map, size, 2, 3) == 5);
+  register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+  free_hash_table(flow_map);
+  free_graph(graph);
+
+  for (int round = 0; round < 20; ++round) {
+    size = 60;
+    graph = create_random_graph(size, 400 + round * 20, 1, 1, 470 + round);
+    // max_flow keeps a single residual edge for a pair of opposite edges, compare on graphs without them
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < i; ++j) {
+        if (get_edge(graph, i, j) && get_edge(graph, j, i)) remove_edge(graph, i, j);
+      }
+    }
+    int source = round % size;
+    int to = (round * 7 + 13) % size;
+    int expected = 0;
+    Hashtable *expected_map = max_flow(graph, source, to, &expected);
+    register_hashtable_free_functions(expected_map, free, (HashtableValueFreeFunc) free_hash_set);
+    free_hash_table(expected_map);
+    flow_map = dinic_max_flow(graph, source, to, &maxflow);
+    assert(maxflow == expected);
+    assert(check_flow(graph, flow_map, size, source, to) == expected);
+    register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+    free_hash_table(flow_map);
+    free_graph(graph);
+  }
+}
+
+void test_push_relabel() {
+  int size = 4;
+  Graph *graph = create_graph(1, 1);
+  for (int i = 0; i < size; ++i) {
+    int id = add_graph_data(graph, NULL);
+    assert(id == i);
+  }
+  add_edge(graph, 0, 1, 3);
+  add_edge(graph, 0, 2, 2);
+  add_edge(graph, 1, 2, 5);
+  add_edge(graph, 1, 3, 2);
+  add_edge(graph, 2, 3, 3);
+  int maxflow = 0;
+  Hashtable *flow_map = push_relabel_max_flow(graph, 0, 3, &maxflow);
+  assert(maxflow == 5);
+  assert(check_flow(graph, flow_map, size, 0, 3) == 5);
+  register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+  free_hash_table(flow_map);
+  free_graph(graph);
+
+  for (int round = 0; round < 30; ++round) {
+    size = 20 + round * 4;
+    // dense rounds leave excess stuck behind saturated cuts for the second phase
+    graph = create_random_graph(size, size * (round % 3 == 0 ? size / 2 : 5), 1, 1, 480 + round);
+    int source = round % size;
+    int to = (round * 7 + 13) % size;
+    int expected = 0;
+    Hashtable *expected_map = dinic_max_flow(graph, source, to, &expected);
+    register_hashtable_free_functions(expected_map, free, (HashtableValueFreeFunc) free_hash_set);
+    free_hash_table(expected_map);
+    flow_map = push_relabel_max_flow(graph, source, to, &maxflow);
+    assert(maxflow == expected);
+    assert(check_flow(graph, flow_map, size, source, to) == expected);
+    register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+    free_hash_table(flow_map);
+    free_graph(graph);
+  }
+}
+
+static int on_source_side(StCut *cut, int id) {
+  for (int i = 0; i < cut->size; ++i) {
+    if (cut->id_list[i] == id) return cut->side[i / 64] >> (i % 64) & 1;
+  }
+  assert(0);
+  return -1;
+}
+
+void test_min_st_cut() {
+  int size = 4;
+  Graph *graph = create_graph(1, 1);
+  for (int i = 0; i < size; ++i) {
+    int id = add_graph_data(graph, NULL);
+    assert(id == i);
+  }
+  add_edge(graph, 0, 1, 3);
+  add_edge(graph, 0, 2, 2);
+  add_edge(graph, 1, 2, 5);
+  add_edge(graph, 1, 3, 2);
+  add_edge(graph, 2, 3, 3);
+  StCut *cut = min_st_cut(graph, 0, 3);
+  assert(cut->value == 5);
+  assert(cut->size == size);
+  // {0} and {0, 1, 2} are both minimum, the source side is the smallest one
+  assert(on_source_side(cut, 0) && !on_source_side(cut, 1) && !on_source_side(cut, 2) && !on_source_side(cut, 3));
+  assert(cut->cut_edge_size == 2);
+  free_st_cut(cut);
+  free_graph(graph);
+
+  for (int round = 0; round < 20; ++round) {
+    size = 100;
+    graph = create_random_graph(size, 150 + round * 40, 1, 1, 490 + round);
+    int source = round % size;
+    int to = (round * 7 + 13) % size;
+    int expected = 0;
+    Hashtable *flow_map = dinic_max_flow(graph, source, to, &expected);
+    register_hashtable_free_functions(flow_map, free, (HashtableValueFreeFunc) free_hash_set);
+    free_hash_table(flow_map);
+    cut = min_st_cut(graph, source, to);
+    assert(cut->value == expected);
+    assert(on_source_side(cut, source) && !on_source_side(cut, to));
+    int weight = 0;
+    for (int i = 0; i < cut->cut_edge_size; ++i) {
+      int from = cut->cut_edges[2 * i];
+      int end = cut->cut_edges[2 * i + 1];
+      assert(on_source_side(cut, from) && !on_source_side(cut, end));
+      weight += get_edge_weight(get_edge(graph, from, end));
+    }
+    assert(weight == expected);
+    int crossing = 0;
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (get_edge(graph, i, j) && on_source_side(cut, i) && !on_source_side(cut, j)) crossing++;
+      }
+    }
+    assert(crossing == cut->cut_edge_size);
+    free_st_cut(cut);
+    free_graph(graph);
+  }
+}
+
+static int cut_value(Graph *graph, StCut *cut) {
+  int value = 0;
+  for (int i = 0; i < cut->cut_edge_size; ++i) {
+    int from = cut->cut_edges[2 * i];
+    int to = cut->cut_edges[2 * i + 1];
+    assert(on_source_side(cut, from) && !on_source_side(cut, to));
+    value += get_edge_weight(get_edge(graph, from, to));
+  }
+  return value;
+}
+
+void test_global_min_cut() {
+  Graph *directed = create_graph(1, 1);
+  add_graph_data(directed, NULL);
+  add_graph_data(directed, NULL);
+  assert(stoer_wagner_min_cut(directed) == NULL);
+  assert(karger_stein_min_cut(directed, 0, 1, 1) == NULL);
+  free_graph(directed);
+
+  // two cliques joined by two light edges
+  int size = 8;
+  Graph *graph = create_graph(0, 1);
+  for (int i = 0; i < size; ++i) {
+    int id = add_graph_data(graph, NULL);
+    assert(id == i);
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i + 1; j < 4; ++j) {
+      add_edge(graph, i, j, 5);
+      add_edge(graph, i + 4, j + 4, 5);
+    }
+  }
+  add_edge(graph, 0, 4, 2);
+  add_edge(graph, 3, 7, 1);
+  StCut *cut = stoer_wagner_min_cut(graph);
+  assert(cut->value == 3);
+  assert(cut->cut_edge_size == 2);
+  assert(cut_value(graph, cut) == 3);
+  assert(on_source_side(cut, 0) == on_source_side(cut, 3) && on_source_side(cut, 0) != on_source_side(cut, 4));
+  free_st_cut(cut);
+  cut = karger_stein_min_cut(graph, 0, 2, 500);
+  assert(cut->value == 3);
+  assert(cut_value(graph, cut) == 3);
+  free_st_cut(cut);
+  // a separate vertex is cut off by nothing
+  add_graph_data(graph, NULL);
+  cut = karger_stein_min_cut(graph, 0, 2, 501);
+  assert(cut->value == 0 && cut->cut_edge_size == 0);
+  free_st_cut(cut);
+  cut = stoer_wagner_min_cut(graph);
+  assert(cut->value == 0 && cut->cut_edge_size == 0);
+  free_st_cut(cut);
+  free_graph(graph);
+
+  for (int round = 0; round < 10; ++round) {
+    size = 16;
+    graph = create_random_graph(size, 40 + round * 6, 0, 1, 510 + round);
+    // every bipartition that keeps vertex size-1 out of the side
+    int expected = INT_MAX;
+    for (int mask = 1; mask < 1 << (size - 1); ++mask) {
+      int value = 0;
+      for (int i = 0; i < size; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+          Edge *edge = get_edge(graph, i, j);
+          if (edge && (mask >> i & 1) != (mask >> j & 1)) value += get_edge_weight(edge);
+        }
+      }
+      if (value < expected) expected = value;
+    }
+    cut = stoer_wagner_min_cut(graph);
+    assert(cut->value == expected);
+    assert(cut_value(graph, cut) == expected);
+    free_st_cut(cut);
+    cut = karger_stein_min_cut(graph, 0, 4, 520 + round);
+    assert(cut->value == expected);
+    assert(cut_value(graph, cut) == expected);
+    free_st_cut(cut);
+    free_graph(graph);
+  }
+
+  // graphs above KARGER_STEIN_BASE go through contraction. two cliques joined by light edges first
+  size = 80;
+  graph = create_graph(0, 1);
+  for (int i = 0; i < size; ++i) add_graph_data(graph, NULL);
+  for (int i = 0; i < size / 2; ++i) {
+    for (int j = i + 1; j < size / 2; ++j) {
+      add_edge(graph, i, j, 3 + (i + j) % 5);
+      add_edge(graph, i + size / 2, j + size / 2, 3 + (i * j) % 5);
+    }
+  }
+  add_edge(graph, 0, size / 2, 2);
+  add_edge(graph, 7, size - 1, 1);
+  add_edge(graph, 13, size / 2 + 9, 2);
+  for (int round = 0; round < 9; ++round) {
+    if (round > 0) {
+      free_graph(graph);
+      size = 60 + round * 5;
+      graph = create_random_graph(size, size * 4, 0, 1, 530 + round);
+    }
+    StCut *expected = stoer_wagner_min_cut(graph);
+    assert(cut_value(graph, expected) == expected->value);
+    if (round == 0) assert(expected->value == 5 && expected->cut_edge_size == 3);
+    cut = karger_stein_min_cut(graph, 0, 4, 540 + round);
+    assert(cut->value == expected->value);
+    assert(cut_value(graph, cut) == expected->value);
+    StCut *single = karger_stein_min_cut(graph, 0, 1, 540 + round);
+    assert(single->value == cut->value);
+    assert(memcmp(single->side, cut->side, sizeof(uint64_t) * ((size + 63) / 64)) == 0);
+    free_st_cut(single);
+    free_st_cut(cut);
+    free_st_cut(expected);
+  }
+  free_graph(graph);
+}
+
 static UnitTestFunction tests[] = {
     test_create_graph_undirected_unweighted,
     test_create_graph_undirected_weighted,
@@ -2045,6 +3503,31 @@ static UnitTestFunction tests[] = {
     test_max_flow,
     test_bipartite_matching,
     test_hungarian,
+    test_direction_optimizing_bfs,
+    test_bfs_par,
+    test_multi_source_bfs,
+    test_dfs_long_chain,
+    test_graph_visit,
+    test_local_search,
+    test_scc_pearce,
+    test_scc_par,
+    test_graph_components_uf,
+    test_graph_components_par,
+    test_connectivity_index,
+    test_dynamic_connectivity,
+    test_biconnectivity,
+    test_cut_index,
+    test_strong_bridge,
+    test_dominator_tree,
+    test_filter_kruskal,
+    test_boruvka_msf,
+    test_msf_stream,
+    test_prim_dense,
+    test_incremental_msf,
+    test_dinic,
+    test_push_relabel,
+    test_min_st_cut,
+    test_global_min_cut,
     NULL
 };
 